@@ -1,131 +1,258 @@
 #include "ai.h"
 
 #include <algorithm>
-#include <functional>
-#include <limits>
-#include <span>
-#include <utility>
+#include <chrono>
+#include <thread>
+#include <vector>
 
-#include "movelist.h"
+#include "threadpool.h"
 
-static constexpr i32 SCORE_MAX = std::numeric_limits<i32>::max();
+AI::AI(const size hashMb) : ownTable(hashMb), table(ownTable), tablebase(), solver(), solverStones(Solver::DEFAULT_STONES), nThreads(1), mode(Mode::LAZY_SMP), driver(Driver::ASPIRATION), quiescence(true), halted(false), searchThread(), searchResult() {
 
-static constexpr i32 SCORE_MIN = std::numeric_limits<i32>::min();
+}
 
-AI::ScoredMove::ScoredMove(size i, i32 score) : i(i), score(score) {
+AI::AI(TTable& sharedTable) : ownTable(0), table(sharedTable), tablebase(), solver(), solverStones(Solver::DEFAULT_STONES), nThreads(1), mode(Mode::LAZY_SMP), driver(Driver::ASPIRATION), quiescence(true), halted(false), searchThread(), searchResult() {
 
 }
 
-std::tuple<u64, i32> AI::find_move(const Game game, const i32 depth) {
-    const bool  isPovTurn   = game.is_pov_turn();
-    u64         bestMove    = 0;
-    i32         bestScore   = isPovTurn ? SCORE_MIN : SCORE_MAX;
-    i32         alpha       = SCORE_MIN;
-    i32         beta        = SCORE_MAX;
+AI::~AI() {
+    stop();
+    wait();
+}
 
-    // Iterate possible moves.
-    for (const auto move: get_sorted_moves(game)) {
-        const i32 score = alpha_beta(game, move, depth - 1, alpha, beta);
+AI::Result AI::find_move(const Game game, const Limits& limits, const Reporter& report) {
+    halted.store(false, std::memory_order_relaxed);
+    return think(game, limits, report);
+}
 
-        if (isPovTurn) {
-            if (score > bestScore) {
-                bestMove    = move;
-                bestScore   = score;
-            }
-            alpha = std::max(alpha, bestScore);
-        } else {
-            if (score < bestScore) {
-                bestMove    = move;
-                bestScore   = score;
-            }
-            beta = std::min(beta, bestScore);
-        }
+void AI::start_search(const Game game, const Limits& limits, const Reporter& report, const Reporter& done) {
+    stop();
+    wait();
+
+    // Clear the flag here rather than on the new thread, so a `stop` right
+    // after this returns isn't lost.
+    halted.store(false, std::memory_order_relaxed);
+    searchThread = std::thread([this, game, limits, report, done](){
+        searchResult = think(game, limits, report);
+        if (done)
+            done(searchResult);
+    });
+}
+
+void AI::stop() {
+    halted.store(true, std::memory_order_relaxed);
+}
+
+std::optional<AI::Result> AI::wait() {
+    if (!searchThread.joinable())
+        return std::nullopt;
+
+    searchThread.join();
+    return searchResult;
+}
+
+bool AI::is_searching() const {
+    return searchThread.joinable();
+}
+
+AI::Result AI::think(const Game game, const Limits& limits, const Reporter& report) {
+    // A finished game has no move to search, and its result is known.
+    if (game.is_over()) {
+        const auto [a, b] = game.get_sides();
+        Result result       = {};
+        result.score        = game.eval();
+        result.isExact      = true;
+        result.stoneDiff    = a.mancala() - b.mancala();
+        return result;
     }
 
-    return std::tuple(bestMove, bestScore);
-}
-
-__attribute__((hot))
-MoveList AI::get_sorted_moves(const Game game) {
-    MoveList                        legalMoves  = game.legal_moves();
-    const size                      nMoves      = legalMoves.n_moves();
-    std::array<ScoredMove, N_PITS>  scoredMoves = {};
-    const auto                      [u, o]      = game.get_turn_user_opp();
-
-    // Score legal moves.
-    for (size i = 0; i < nMoves; i++)
-        scoredMoves[i] = ScoredMove(i, score_move(u, o, legalMoves[i]));
-
-    // Sort moves based on score.
-    std::span<ScoredMove> movesToSort(scoredMoves.begin(), nMoves);
-    std::sort(
-        movesToSort.begin(),
-        movesToSort.end(),
-        [](auto a, auto b){ return a.score > b.score; }
-    );
-    
-    // Get final sorted move list.
-    MoveList orderedMoves(nMoves);
-    for (size i = 0; i < nMoves; i++)
-        orderedMoves[i] = legalMoves[scoredMoves[i].i];
-
-    return orderedMoves;
-}
-
-__attribute__((hot))
-i32 AI::alpha_beta(Game game, const u8 move, const i32 depth, i32 a, i32 b) {
-    // This is OK because only legal moves are iterated.
-    game.make_move_unchecked(move);
-
-    // Break for depth or game end.
-    if (depth < 1 || game.is_over())
-        return game.eval();
-
-    i32     score   = 0;
-    auto    moves   = get_sorted_moves(game);
-
-    // PoV move; find response with highest score.
-    if (game.is_pov_turn()) {
-        score = SCORE_MIN;
-
-        for (const auto move: moves) {
-            score = std::max(score, alpha_beta(game, move, depth - 1, a, b));
-            if (score >= b)
-                break;
-            else
-                a = std::max(a, score);
-        }
-    } 
-
-    // Other side move; find response with lowest score.
-    else {
-        score = SCORE_MAX;
-
-        for (const auto move: moves) {
-            score = std::min(score, alpha_beta(game, move, depth - 1, a, b));
-            if (score <= a)
-                break;
-            else
-                b = std::min(b, score);
+    // Small endgames are cheaper to solve than to search.
+    Limits searchLimits = limits;
+    if (solverStones > 0 && !game.is_over() && game.n_pit_stones() <= static_cast<i32>(solverStones)) {
+        // The solver gets half of any time or node budget. A depth alone
+        // doesn't bound a solve, so it gets a fixed node budget instead.
+        const bool      isBudgeted      = limits.movetime > 0 || limits.nodes > 0;
+        const Limits    solverLimits    = {
+            limits.depth,
+            limits.movetime / 2,
+            isBudgeted ? limits.nodes / 2 : Solver::DEFAULT_NODES
+        };
+        const auto solveStart = Search::Clock::now();
+        if (const auto solved = solve(game, solverLimits, report))
+            return solved.value();
+
+        // Leave the search what the solver didn't use, keeping a budget of at
+        // least one so it doesn't become no limit.
+        const auto solveTime = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            Search::Clock::now() - solveStart
+        ).count());
+        if (limits.movetime > 0)
+            searchLimits.movetime -= std::min(solveTime, limits.movetime - 1);
+        if (limits.nodes > 0)
+            searchLimits.nodes -= std::min(solver.n_nodes(), limits.nodes - 1);
+    }
+
+    return search(game, searchLimits, report);
+}
+
+AI::Result AI::search(const Game game, const Limits& limits, const Reporter& report) {
+    Search::Shared              shared(table, limits);
+    std::vector<Search>         searches;
+    Result                      result      = {};
+
+    if (&table == &ownTable)
+        table.new_search();
+    shared.deterministic    = mode == Mode::YBWC;
+    shared.driver           = driver;
+    shared.quiescence       = quiescence;
+    shared.tablebase        = tablebase.is_loaded() ? &tablebase : nullptr;
+    shared.report           = report;
+    shared.halt             = &halted;
+    for (size i = 0; i < nThreads; i++)
+        searches.emplace_back(shared, i);
+
+    if (nThreads > 1 && mode == Mode::YBWC) {
+        // Search on this thread, handing siblings to the pool's workers.
+        {
+            ThreadPool pool(nThreads);
+            shared.pool     = &pool;
+            shared.searches = &searches;
+            result = searches[0].run(game);
         }
+
+        // Count what the workers searched since they last checked in.
+        for (auto& search: searches)
+            search.share_nodes();
+    } else {
+        std::vector<Result>         results(nThreads);
+        std::vector<std::thread>    helpers;
+
+        // Start the helpers, then search on this thread as the main thread.
+        for (size i = 1; i < nThreads; i++)
+            helpers.emplace_back([&, i](){ results[i] = searches[i].run(game); });
+        results[0] = searches[0].run(game);
+        for (auto& helper: helpers)
+            helper.join();
+
+        // Prefer the deepest completed iteration, breaking ties with the main thread.
+        result = results[0];
+        for (const auto& helperResult: results)
+            if (helperResult.depth > result.depth)
+                result = helperResult;
+    }
+
+    result.nodes    = shared.nodes.load(std::memory_order_relaxed);
+    result.tbProbes = shared.tbProbes.load(std::memory_order_relaxed);
+    result.tbHits   = shared.tbHits.load(std::memory_order_relaxed);
+    result.stats    = shared.stats;
+    result.time     = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        Search::Clock::now() - shared.startTime
+    ).count());
+
+    return result;
+}
+
+std::optional<AI::Result> AI::solve(const Game game, const Limits& limits, const Reporter& report) {
+    const auto  start       = Search::Clock::now();
+    const auto  solution    = solver.solve(game, limits, tablebase.is_loaded() ? &tablebase : nullptr, &halted);
+    if (!solution)
+        return std::nullopt;
+
+    // Score a win or loss in the search's range, by the plies along the line
+    // until the mancalas decide it. The line keeps the most stones rather than
+    // winning fastest, so these scores aren't ordered by distance as the
+    // search's are.
+    i32     distance    = 0;
+    Game    child       = game;
+    while (distance < static_cast<i32>(solution->pv.length) && !child.is_decided() && !child.is_over())
+        child.make_move_unchecked(solution->pv.moves[distance++]);
+
+    Result result       = {};
+    result.move         = solution->move;
+    result.score        = solution->diff > 0
+        ? EW_WINNING - distance
+        : solution->diff < 0
+            ? -EW_WINNING + distance
+            : 0;
+    result.pv           = solution->pv;
+    result.depth        = static_cast<i32>(solution->pv.length);
+    result.nodes        = solution->nodes;
+    result.time         = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        Search::Clock::now() - start
+    ).count());
+    result.iterTime     = result.time;
+    result.isExact      = true;
+    result.stoneDiff    = solution->diff;
+
+    if (report)
+        report(result);
+
+    return result;
+}
+
+TTable& AI::get_table() {
+    return table;
+}
+
+Tablebase& AI::get_tablebase() {
+    return tablebase;
+}
+
+u32 AI::get_solver_stones() const {
+    return solverStones;
+}
+
+void AI::set_solver_stones(const u32 n) {
+    solverStones = std::min(n, Solver::MAX_STONES);
+}
+
+size AI::get_threads() const {
+    return nThreads;
+}
+
+void AI::set_threads(const size n) {
+    nThreads = std::clamp<size>(n, 1, MAX_THREADS);
+}
+
+AI::Mode AI::get_mode() const {
+    return mode;
+}
+
+void AI::set_mode(const Mode mode) {
+    this->mode = mode;
+}
+
+str AI::mode_name(const Mode mode) {
+    switch (mode) {
+        case Mode::LAZY_SMP:    return "lazysmp";
+        case Mode::YBWC:        return "ybwc";
     }
 
-    return score;
+    return "";
 }
 
-__attribute__((hot))
-i32 AI::score_move(const Side u, const Side o, const u8 i) {
-    const u8 nStones = static_cast<u8>(u.pit(i));
+AI::Driver AI::get_driver() const {
+    return driver;
+}
 
-    if (nStones < i && u.pit(i - nStones) == 0) {
-        // Captures are best to try first.
-        const u64 opStones = o.pit(7 + nStones - i);
-        if (opStones > 0)
-            return 2'000 + opStones;
-    } else if (nStones == i)
-        // Chains are good; prioritize ones closer to the mancala.
-        return 1'000 - i;
+void AI::set_driver(const Driver driver) {
+    this->driver = driver;
+}
+
+str AI::driver_name(const Driver driver) {
+    switch (driver) {
+        case Driver::FULL_WINDOW:   return "full";
+        case Driver::ASPIRATION:    return "aspiration";
+        case Driver::MTDF:          return "mtdf";
+    }
+
+    return "";
+}
+
+bool AI::get_quiescence() const {
+    return quiescence;
+}
 
-    // Nothing significant about the move.
-    return 0;
+void AI::set_quiescence(const bool quiescence) {
+    this->quiescence = quiescence;
 }
@@ -1,51 +1,278 @@
 #pragma once
 
-#include <array>
-#include <tuple>
+#include <atomic>
+#include <optional>
+#include <thread>
 
 #include "def.h"
 #include "game.h"
-#include "side.h"
+#include "search.h"
+#include "solver.h"
+#include "tablebase.h"
+#include "ttable.h"
 
 class AI {
-private:
-    struct ScoredMove {
+public:
+    using Limits = Search::Limits;
+
+    using Result = Search::Result;
+
+    using Reporter = Search::Reporter;
+
+    using Driver = Search::Driver;
+
+    /**
+     * @brief The deepest iteration a search will start.
+     */
+    static constexpr inline i32 MAX_DEPTH = Search::MAX_DEPTH;
+
+    /**
+     * @brief The most search threads allowed.
+     */
+    static constexpr inline size MAX_THREADS = 256;
+
+    /**
+     * @brief How multiple threads share a search.
+     */
+    enum class Mode {
         /**
-         * @brief The move's index in a `MoveList`.
+         * @brief Every thread searches the whole tree, sharing the table.
          */
-        size i;
+        LAZY_SMP,
 
         /**
-         * @brief The move's score.
+         * @brief Nodes are split across a work-stealing pool with Young
+         * Brothers Wait. Results at a fixed depth don't depend on timing.
          */
-        i32 score;
+        YBWC,
+    };
 
-        constexpr ScoredMove() : i(), score() {
+private:
+    /**
+     * @brief The engine's own transposition table, left at one entry if it
+     * shares another's.
+     */
+    TTable ownTable;
 
-        }
+    /**
+     * @brief The transposition table shared by all searches and threads.
+     */
+    TTable& table;
 
-        explicit ScoredMove(size i, i32 score);
-    };
+    /**
+     * @brief The endgame tablebase.
+     */
+    Tablebase tablebase;
+
+    /**
+     * @brief The exact endgame solver.
+     */
+    Solver solver;
+
+    /**
+     * @brief The number of stones in the pits at or below which positions are
+     * solved instead of searched, or 0 to always search.
+     */
+    u32 solverStones;
+
+    /**
+     * @brief The number of threads to search with.
+     */
+    size nThreads;
+
+    /**
+     * @brief How threads share a search.
+     */
+    Mode mode;
+
+    /**
+     * @brief How each iteration searches the root.
+     */
+    Driver driver;
+
+    /**
+     * @brief Is `true` if searches extend the horizon by captures and chains.
+     */
+    bool quiescence;
+
+    /**
+     * @brief Set by `stop` to end the search in progress once it has completed
+     * an iteration, so there is always a move.
+     */
+    std::atomic<bool> halted;
+
+    /**
+     * @brief The thread running the search started by `start_search`.
+     */
+    std::thread searchThread;
+
+    /**
+     * @brief The result of the search started by `start_search`, written by
+     * `searchThread`.
+     */
+    Result searchResult;
 
 public:
     /**
-     * @brief Searches to the given depth and returns the optimal move found and the evaluation.
+     * @brief An engine with a transposition table of the given size in megabytes.
+     */
+    explicit AI(size hashMb = TTable::DEFAULT_MB);
+
+    /**
+     * @brief An engine searching with the given transposition table, which
+     * other engines may be searching with at the same time.
+     *
+     * @details Searches don't age a shared table, since that would make the
+     * entries of other searches still running replaceable; its owner calls
+     * `TTable::new_search` instead.
+     */
+    explicit AI(TTable& sharedTable);
+
+    ~AI();
+
+    /**
+     * @brief Searches with iterative deepening until the depth, time, or node
+     * limit and returns the result of the last completed iteration.
+     *
+     * @details With more than one thread, the threads either search the same
+     * position and share results through the transposition table (Lazy SMP) or
+     * split the tree between them (YBWC). If given, `report` is called with
+     * the progress after each completed iteration.
+     *
+     * Positions with at most `get_solver_stones` stones in the pits are solved
+     * to the end of the game instead, giving an exact result, as long as half
+     * the time and node budget is enough, or `Solver::DEFAULT_NODES` if only
+     * the depth is limited; the search gets the rest otherwise.
+     *
+     * A finished game isn't searched: the result is its exact final score,
+     * with no move and a depth of 0.
      */
-    static std::tuple<u64, i32> find_move(Game game, i32 depth);
+    Result find_move(Game game, const Limits& limits, const Reporter& report = {});
+
+    /**
+     * @brief Starts `find_move` on another thread and returns at once, calling
+     * `done` with the result on that thread when the search ends.
+     *
+     * @details Stops and waits for the search in progress first, if any.
+     * Nothing else may use the AI until `wait` returns.
+     */
+    void start_search(Game game, const Limits& limits, const Reporter& report = {}, const Reporter& done = {});
+
+    /**
+     * @brief Ends the search started by `start_search` as soon as it has
+     * completed an iteration, including the solver's if it is solving.
+     *
+     * @details Safe to call from any thread, and before the search has begun.
+     */
+    void stop();
+
+    /**
+     * @brief Waits for the search started by `start_search` to end.
+     *
+     * @return The result of its last completed iteration, or nothing if no
+     * search was started since the last wait.
+     */
+    std::optional<Result> wait();
+
+    /**
+     * @brief Returns `true` if a search was started by `start_search` and not
+     * yet waited for.
+     */
+    bool is_searching() const;
+
+    /**
+     * @brief Returns the transposition table.
+     */
+    TTable& get_table();
+
+    /**
+     * @brief Returns the endgame tablebase.
+     */
+    Tablebase& get_tablebase();
+
+    /**
+     * @brief Returns the number of stones in the pits at or below which
+     * positions are solved, or 0 if they are always searched.
+     */
+    u32 get_solver_stones() const;
+
+    /**
+     * @brief Sets the number of stones in the pits at or below which positions
+     * are solved, clamped to `Solver::MAX_STONES`, or 0 to always search.
+     */
+    void set_solver_stones(u32 n);
+
+    /**
+     * @brief Returns the number of search threads.
+     */
+    size get_threads() const;
+
+    /**
+     * @brief Sets the number of search threads, clamped to [1, `MAX_THREADS`].
+     */
+    void set_threads(size n);
+
+    /**
+     * @brief Returns how threads share a search.
+     */
+    Mode get_mode() const;
+
+    /**
+     * @brief Sets how threads share a search.
+     */
+    void set_mode(Mode mode);
+
+    /**
+     * @brief Returns the name of the given mode.
+     */
+    static str mode_name(Mode mode);
+
+    /**
+     * @brief Returns how each iteration searches the root.
+     */
+    Driver get_driver() const;
+
+    /**
+     * @brief Sets how each iteration searches the root.
+     */
+    void set_driver(Driver driver);
+
+    /**
+     * @brief Returns the name of the given driver.
+     */
+    static str driver_name(Driver driver);
+
+    /**
+     * @brief Returns `true` if searches extend the horizon by captures and chains.
+     */
+    bool get_quiescence() const;
+
+    /**
+     * @brief Sets whether searches extend the horizon by captures and chains.
+     */
+    void set_quiescence(bool quiescence);
 
 private:
-    /** 
-     * @brief Returns the legal moves sorted by instant potential in ascending order.
+    /**
+     * @brief Solves the position within the limits, reporting it as one
+     * iteration if given `report`.
+     *
+     * @details A win or loss scores as a decided result by the plies until
+     * the solved line decides it. That line keeps the most stones rather than
+     * winning fastest, so unlike the search's, solved scores aren't ordered by
+     * distance.
+     *
+     * @return The exact result, or nothing if the position wasn't solved.
      */
-    static MoveList get_sorted_moves(Game game);
+    std::optional<Result> solve(Game game, const Limits& limits, const Reporter& report);
 
-    /** 
-     * @brief Alpha beta prune depth search.
+    /**
+     * @brief `find_move`, without clearing `halted`.
      */
-    static i32 alpha_beta(Game game, u8 move, i32 depth, i32 a, i32 b);
+    Result think(Game game, const Limits& limits, const Reporter& report);
 
     /**
-     * @brief Scores the given move.
+     * @brief Searches the position within the limits, without the solver.
      */
-    static i32 score_move(Side u, Side o, u8 move);
+    Result search(Game game, const Limits& limits, const Reporter& report);
 };
@@ -0,0 +1,253 @@
+#include "analysis.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "game.h"
+#include "mappedfile.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Stands for an input position that could not be read.
+     */
+    constexpr inline u32 NO_POSITION = std::numeric_limits<u32>::max();
+
+    /**
+     * @brief The number of records or answers buffered before each write.
+     */
+    constexpr inline size WRITE_BATCH = 4096;
+
+    /**
+     * @brief Returns the milliseconds since the given time.
+     */
+    u64 elapsed(const Clock::time_point start) {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+    }
+
+    /**
+     * @brief The distinct positions of an input, and which of them each input
+     * position is.
+     */
+    class Positions {
+    private:
+        struct Hash {
+            size operator()(const Analysis::Record& record) const {
+                return Game(Side::from_bits(record.a), Side::from_bits(record.b)).hash();
+            }
+        };
+
+        struct Equal {
+            bool operator()(const Analysis::Record& x, const Analysis::Record& y) const {
+                return x.a == y.a && x.b == y.b;
+            }
+        };
+
+        /**
+         * @brief Each distinct position's index in `games`.
+         */
+        std::unordered_map<Analysis::Record, u32, Hash, Equal> indices;
+
+    public:
+        /**
+         * @brief The distinct positions in the order first read.
+         */
+        std::vector<Game> games;
+
+        /**
+         * @brief Each input position's index in `games`, or `NO_POSITION`.
+         */
+        std::vector<u32> order;
+
+        size nInvalid = 0;
+
+        /**
+         * @brief Adds the next input position, if it could be read.
+         */
+        void add(const std::optional<Game>& game) {
+            if (!game) {
+                order.push_back(NO_POSITION);
+                nInvalid++;
+                return;
+            }
+
+            const auto [a, b]       = game->get_sides();
+            const auto [it, isNew]  = indices.try_emplace(Analysis::Record{ a.bits(), b.bits() }, static_cast<u32>(games.size()));
+            if (isNew)
+                games.push_back(game.value());
+            order.push_back(it->second);
+        }
+    };
+}
+
+std::string Analysis::format_name(const Format format) {
+    switch (format) {
+        case Format::TEXT:
+            return "text";
+        case Format::BINARY:
+            return "binary";
+    }
+
+    return "unknown";
+}
+
+std::optional<Analysis::Progress> Analysis::run(
+    const std::string& inPath,
+    const std::string& outPath,
+    const Format format,
+    const Options& options,
+    const Reporter& report
+) {
+    const auto  start       = Clock::now();
+    Positions   positions;
+
+    // Read the input, keeping one copy of each position.
+    if (format == Format::TEXT) {
+        std::ifstream in(inPath);
+        if (!in)
+            return std::nullopt;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            positions.add(Game::from_notation(line));
+        }
+    } else {
+        MappedFile file;
+        if (!file.open(inPath) || file.size_bytes() % sizeof(Record) != 0)
+            return std::nullopt;
+
+        const Record*   records     = reinterpret_cast<const Record*>(file.data());
+        const size      nRecords    = file.size_bytes() / sizeof(Record);
+        for (size i = 0; i < nRecords; i++)
+            positions.add(Game::from_bits(records[i].a, records[i].b));
+    }
+
+    // Fail before searching if there's nowhere to write the results.
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return std::nullopt;
+
+    // Search the distinct positions, each thread with its own AI.
+    const auto&         games   = positions.games;
+    std::vector<Answer> answers(games.size());
+    std::atomic<size>   next    = 0;
+    std::atomic<size>   nDone   = 0;
+    std::atomic<u64>    nodes   = 0;
+    const auto progress = [&](){
+        return Progress{
+            positions.order.size(), games.size(), positions.nInvalid,
+            nDone.load(std::memory_order_relaxed), nodes.load(std::memory_order_relaxed), elapsed(start)
+        };
+    };
+    const auto work = [&](const bool isReporter){
+        AI      ai(options.hashMb);
+        auto    lastReport = Clock::now();
+        for (size i = next++; i < games.size(); i = next++) {
+            const Game& game    = games[i];
+            const auto  result  = ai.find_move(game, options.limits);
+            answers[i] = Answer{ result.mover_score(game.is_pov_turn()), static_cast<u8>(result.move), static_cast<u8>(result.depth), 0 };
+            nodes.fetch_add(result.nodes, std::memory_order_relaxed);
+            nDone.fetch_add(1, std::memory_order_relaxed);
+
+            if (isReporter && report && elapsed(lastReport) >= REPORT_INTERVAL) {
+                lastReport = Clock::now();
+                report(progress());
+            }
+        }
+    };
+
+    std::vector<std::thread>    threads;
+    const size                  nWorkers    = std::clamp<size>(options.nThreads, 1, std::max<size>(games.size(), 1));
+    for (size i = 1; i < nWorkers; i++)
+        threads.emplace_back(work, false);
+    work(true);
+    for (auto& thread: threads)
+        thread.join();
+
+    // Write each input position's result in order.
+    if (format == Format::TEXT) {
+        std::string buffer;
+        for (size i = 0; i < positions.order.size(); i++) {
+            const u32 index = positions.order[i];
+            if (index == NO_POSITION)
+                buffer += "invalid\n";
+            else {
+                const Answer& answer = answers[index];
+                std::format_to(std::back_inserter(buffer), "{} {} {}\n", answer.move, answer.score, answer.depth);
+            }
+
+            if ((i + 1) % WRITE_BATCH == 0 || i + 1 == positions.order.size()) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+    } else {
+        std::vector<Answer> buffer;
+        for (size i = 0; i < positions.order.size(); i++) {
+            const u32 index = positions.order[i];
+            buffer.push_back(index == NO_POSITION
+                ? Answer{ 0, 0, 0, INVALID }
+                : answers[index]
+            );
+
+            if (buffer.size() == WRITE_BATCH || i + 1 == positions.order.size()) {
+                out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Answer)));
+                buffer.clear();
+            }
+        }
+    }
+
+    out.flush();
+    if (!out)
+        return std::nullopt;
+
+    return progress();
+}
+
+std::optional<size> Analysis::convert(const std::string& inPath, const std::string& outPath) {
+    std::ifstream in(inPath);
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!in || !out)
+        return std::nullopt;
+
+    std::vector<Record> buffer;
+    std::string         line;
+    size                nRecords    = 0;
+    const auto flush = [&](){
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Record)));
+        buffer.clear();
+    };
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        // Zeros have no side to move, so they read back as invalid.
+        const auto game = Game::from_notation(line);
+        if (game) {
+            const auto [a, b] = game->get_sides();
+            buffer.push_back(Record{ a.bits(), b.bits() });
+        } else
+            buffer.push_back(Record{ 0, 0 });
+        nRecords++;
+
+        if (buffer.size() == WRITE_BATCH)
+            flush();
+    }
+    flush();
+
+    out.flush();
+    if (!out)
+        return std::nullopt;
+
+    return nRecords;
+}
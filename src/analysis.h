@@ -0,0 +1,178 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "ai.h"
+#include "def.h"
+
+/**
+ * @brief Searches every position in a file and writes the best move and score
+ * of each to another, in input order.
+ *
+ * @details Positions are read as text, one in `Game` notation per line, or as
+ * fixed-width binary `Record`s, which are memory-mapped. A position repeated
+ * anywhere in the input is searched once. Each thread takes the next position
+ * not yet searched with its own AI, whose table carries over between
+ * positions, so results can depend on which thread searched what.
+ */
+class Analysis {
+public:
+    /**
+     * @brief A position in a binary input file.
+     */
+    struct Record {
+        /**
+         * @brief The PoV side's bits.
+         */
+        u64 a;
+
+        /**
+         * @brief The upper side's bits.
+         */
+        u64 b;
+    };
+
+    /**
+     * @brief A position's result in a binary output file.
+     */
+    struct Answer {
+        /**
+         * @brief The evaluation from the side to move's perspective.
+         */
+        i32 score;
+
+        /**
+         * @brief The best move, or 0 if the game is over or the position invalid.
+         */
+        u8 move;
+
+        /**
+         * @brief The depth of the last completed iteration.
+         */
+        u8 depth;
+
+        /**
+         * @brief `INVALID` if the position could not be read, 0 if not.
+         */
+        u16 flags;
+    };
+
+    /**
+     * @brief Marks the answer to a position that could not be read.
+     */
+    static constexpr inline u16 INVALID = 1;
+
+    /**
+     * @brief The default size of each thread's transposition table in megabytes.
+     */
+    static constexpr inline size DEFAULT_MB = 16;
+
+    /**
+     * @brief How often progress is reported in milliseconds.
+     */
+    static constexpr inline u64 REPORT_INTERVAL = 1000;
+
+    /**
+     * @brief How the input and output files are laid out.
+     */
+    enum class Format {
+        /**
+         * @brief Lines of `Game` notation in; lines of "<move> <score> <depth>",
+         * or "invalid", out.
+         */
+        TEXT,
+
+        /**
+         * @brief `Record`s in; `Answer`s out.
+         */
+        BINARY
+    };
+
+    struct Options {
+        /**
+         * @brief The limits of each position's search, which must set a depth.
+         */
+        AI::Limits limits;
+
+        /**
+         * @brief The number of positions searched at once.
+         */
+        size nThreads;
+
+        /**
+         * @brief The size of each thread's transposition table in megabytes.
+         */
+        size hashMb;
+    };
+
+    /**
+     * @brief The state of a run, reported while searching and returned at the end.
+     */
+    struct Progress {
+        /**
+         * @brief The number of positions read, invalid ones included.
+         */
+        size nPositions;
+
+        /**
+         * @brief The number of distinct valid positions.
+         */
+        size nUnique;
+
+        /**
+         * @brief The number of positions that could not be read.
+         */
+        size nInvalid;
+
+        /**
+         * @brief The number of distinct positions searched so far.
+         */
+        size nDone;
+
+        /**
+         * @brief The number of nodes searched so far.
+         */
+        u64 nodes;
+
+        /**
+         * @brief The time since the input was opened in milliseconds.
+         */
+        u64 time;
+    };
+
+    /**
+     * @brief Called with the progress while searching.
+     */
+    using Reporter = std::function<void(const Progress&)>;
+
+    /**
+     * @brief Returns the name of the format.
+     */
+    static std::string format_name(Format format);
+
+    /**
+     * @brief Searches every position in the input file and writes the results
+     * to the output file, reporting progress every `REPORT_INTERVAL`.
+     *
+     * @return The final progress, or `nullopt` if the input could not be read
+     * or the output written. A binary input must be a whole number of records.
+     */
+    static std::optional<Progress> run(
+        const std::string& inPath,
+        const std::string& outPath,
+        Format format,
+        const Options& options,
+        const Reporter& report = {}
+    );
+
+    /**
+     * @brief Writes the positions in a text input file as a binary one, a
+     * record of zeros standing for each line that isn't a position.
+     *
+     * @return The number of records written, or `nullopt` if the input could
+     * not be read or the output written.
+     */
+    static std::optional<size> convert(const std::string& inPath, const std::string& outPath);
+};
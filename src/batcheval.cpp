@@ -0,0 +1,135 @@
+#include "batcheval.h"
+
+#include <algorithm>
+
+#include "game.h"
+#include "side.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROCKHOP_BATCH_AVX2
+#endif
+
+namespace {
+    /**
+     * @brief The kernel `BatchEval::evaluate` runs, chosen once for the CPU.
+     */
+    const auto KERNEL = BatchEval::has_avx2() ? &BatchEval::evaluate_avx2 : &BatchEval::evaluate_scalar;
+
+#ifdef ROCKHOP_BATCH_AVX2
+    /**
+     * @brief Returns `Game::eval` of four positions from their sides' words,
+     * one per 64-bit lane.
+     */
+    __attribute__((target("avx2")))
+    inline __m256i eval_lanes(const __m256i a, const __m256i b) {
+        const __m256i manMask   = _mm256_set1_epi64x(0xFF);
+        const __m256i pitMask   = _mm256_set1_epi64x(0x00FFFFFFFFFFFF00LL);
+        const __m256i zero      = _mm256_setzero_si256();
+
+        // Sum each side's pit bytes, leaving the mancala and turn bit out.
+        const __m256i aMancala  = _mm256_and_si256(a, manMask);
+        const __m256i bMancala  = _mm256_and_si256(b, manMask);
+        const __m256i aPits     = _mm256_sad_epu8(_mm256_and_si256(a, pitMask), zero);
+        const __m256i bPits     = _mm256_sad_epu8(_mm256_and_si256(b, pitMask), zero);
+
+        // The differences fit in the low 32 bits the multiplies read.
+        __m256i score = _mm256_add_epi64(
+            _mm256_mul_epi32(_mm256_sub_epi64(aMancala, bMancala), _mm256_set1_epi64x(EW_STONE_IN_MANCALA)),
+            _mm256_mul_epi32(_mm256_sub_epi64(aPits, bPits), _mm256_set1_epi64x(EW_STONE_IN_PIT))
+        );
+
+        // Build `Game::bounds` from the mancalas and clamp to them.
+        const __m256i win       = _mm256_set1_epi64x(EW_WINNING);
+        const __m256i loss      = _mm256_set1_epi64x(-EW_WINNING);
+        const __m256i toWin     = _mm256_set1_epi64x(N_STONES_TO_WIN - 1);
+        const __m256i toDraw    = _mm256_set1_epi64x(N_STONES_TO_DRAW - 1);
+        const __m256i lower     = _mm256_blendv_epi8(
+            _mm256_blendv_epi8(loss, zero, _mm256_cmpgt_epi64(aMancala, toDraw)),
+            win,
+            _mm256_cmpgt_epi64(aMancala, toWin)
+        );
+        const __m256i upper     = _mm256_blendv_epi8(
+            _mm256_blendv_epi8(win, zero, _mm256_cmpgt_epi64(bMancala, toDraw)),
+            loss,
+            _mm256_cmpgt_epi64(bMancala, toWin)
+        );
+        score = _mm256_blendv_epi8(score, upper, _mm256_cmpgt_epi64(score, upper));
+        score = _mm256_blendv_epi8(score, lower, _mm256_cmpgt_epi64(lower, score));
+
+        return score;
+    }
+#endif
+}
+
+void BatchEval::evaluate(const Batch& batch, const bool isPovTurn, const i32 ply, Scores& scores) {
+    KERNEL(batch, isPovTurn, ply, scores);
+}
+
+void BatchEval::evaluate_scalar(const Batch& batch, const bool isPovTurn, const i32 ply, Scores& scores) {
+    for (size i = 0; i < batch.n; i++) {
+        const Side pov = Side::from_bits(batch.a[i]);
+        const Side opp = Side::from_bits(batch.b[i]);
+
+        // Score the child as `Game::eval` does.
+        const auto  [lower, upper]  = Game::bounds(pov, opp);
+        const i32   eval            = std::clamp(
+            (pov.mancala() - opp.mancala()) * EW_STONE_IN_MANCALA + (pov.n_pit_stones() - opp.n_pit_stones()) * EW_STONE_IN_PIT,
+            lower,
+            upper
+        );
+
+        // Whoever moves next, the side that moved sees the PoV's score the
+        // same way, and prefers the quickest win and slowest loss.
+        i32 score = isPovTurn ? eval : -eval;
+        if (score == EW_WINNING)
+            score = EW_WINNING - ply;
+        else if (score == -EW_WINNING)
+            score = -EW_WINNING + ply;
+
+        scores[i] = score;
+    }
+}
+
+#ifdef ROCKHOP_BATCH_AVX2
+__attribute__((target("avx2")))
+void BatchEval::evaluate_avx2(const Batch& batch, const bool isPovTurn, const i32 ply, Scores& scores) {
+    // Score the children four at a time, then gather the scores' low halves
+    // into one register.
+    const __m256i low       = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m256i first     = eval_lanes(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.a.data())),
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.b.data()))
+    );
+    const __m256i second    = eval_lanes(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.a.data() + 4)),
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(batch.b.data() + 4))
+    );
+    __m256i result = _mm256_blend_epi32(
+        _mm256_permutevar8x32_epi32(first, low),
+        _mm256_permutevar8x32_epi32(second, low),
+        0xF0
+    );
+
+    // Turn to the mover's perspective and mark the wins and losses by ply.
+    if (!isPovTurn)
+        result = _mm256_sub_epi32(_mm256_setzero_si256(), result);
+    result = _mm256_blendv_epi8(result, _mm256_set1_epi32(EW_WINNING - ply), _mm256_cmpeq_epi32(result, _mm256_set1_epi32(EW_WINNING)));
+    result = _mm256_blendv_epi8(result, _mm256_set1_epi32(-EW_WINNING + ply), _mm256_cmpeq_epi32(result, _mm256_set1_epi32(-EW_WINNING)));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(scores.data()), result);
+}
+
+bool BatchEval::has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#else
+void BatchEval::evaluate_avx2(const Batch& batch, const bool isPovTurn, const i32 ply, Scores& scores) {
+    evaluate_scalar(batch, isPovTurn, ply, scores);
+}
+
+bool BatchEval::has_avx2() {
+    return false;
+}
+#endif
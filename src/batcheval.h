@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+
+#include "config.h"
+#include "def.h"
+
+class BatchEval {
+public:
+    /**
+     * @brief The most positions in a batch, every child of a node and padding
+     * to fill two AVX2 registers.
+     */
+    static constexpr inline size MAX_SIZE = 8;
+
+    /**
+     * @brief The children of a node, in the order they would be searched.
+     */
+    struct Batch {
+        /**
+         * @brief Each child's PoV side, as returned by `Side::bits`.
+         */
+        alignas(32) std::array<u64, MAX_SIZE> a;
+
+        /**
+         * @brief Each child's other side, as returned by `Side::bits`.
+         */
+        alignas(32) std::array<u64, MAX_SIZE> b;
+
+        /**
+         * @brief The number of children, at most `N_PITS`.
+         */
+        size n;
+    };
+
+    /**
+     * @brief Each child's score, in the order of the batch.
+     */
+    using Scores = std::array<i32, MAX_SIZE>;
+
+    /**
+     * @brief Scores every child as `Game::eval` would without a tablebase, from
+     * the perspective of the side that moved into it, marking wins and losses
+     * by the given ply as `Search::evaluate` does.
+     *
+     * @details Runs the AVX2 kernel if the CPU has it, the scalar one if not.
+     * Scores past the batch's size are left unspecified.
+     */
+    static void evaluate(const Batch& batch, bool isPovTurn, i32 ply, Scores& scores);
+
+    /**
+     * @brief `evaluate` one child at a time.
+     */
+    static void evaluate_scalar(const Batch& batch, bool isPovTurn, i32 ply, Scores& scores);
+
+    /**
+     * @brief `evaluate` with every child at once in AVX2 registers.
+     *
+     * @warning Only call if `has_avx2` returns `true`.
+     */
+    static void evaluate_avx2(const Batch& batch, bool isPovTurn, i32 ply, Scores& scores);
+
+    /**
+     * @brief Returns `true` if the AVX2 kernel is built in and the CPU runs it.
+     */
+    static bool has_avx2();
+};
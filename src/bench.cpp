@@ -0,0 +1,673 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <print>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "server.h"
+
+namespace {
+    /**
+     * @brief A side to move, its opponent, and a move to sow.
+     */
+    struct Sow {
+        Side user;
+        Side op;
+        u8   move;
+    };
+
+    /**
+     * @brief Returns `true` if both kernels leave the board the same after the
+     * move and agree on whether it chains.
+     */
+    bool is_same_sowing(const Sow& sow) {
+        Side    tableUser   = sow.user;
+        Side    tableOp     = sow.op;
+        Side    shiftsUser  = sow.user;
+        Side    shiftsOp    = sow.op;
+        const bool tableChain   = tableUser.sow_table(sow.move, tableOp);
+        const bool shiftsChain  = shiftsUser.sow_shifts(sow.move, shiftsOp);
+
+        return tableChain == shiftsChain && tableUser.bits() == shiftsUser.bits() && tableOp.bits() == shiftsOp.bits();
+    }
+
+    /**
+     * @brief Compares the kernels on every move from the position down to the
+     * given plies, counting the moves checked and those that differ.
+     */
+    void verify_sowing_from(const Game& game, const i32 plies, u64& nChecked, u64& nDiffering) {
+        if (plies == 0 || game.is_over())
+            return;
+
+        const auto [user, op] = game.get_turn_user_opp();
+        for (const auto move: game.legal_moves()) {
+            nChecked++;
+            nDiffering += !is_same_sowing({ user, op, move });
+
+            Game child = game;
+            child.make_move_unchecked(move);
+            verify_sowing_from(child, plies - 1, nChecked, nDiffering);
+        }
+    }
+
+    /**
+     * @brief Returns the evaluation from the side to move's perspective.
+     */
+    i32 eval_to_move(const Game& game) {
+        return game.is_pov_turn() ? game.eval() : -game.eval();
+    }
+
+    i32 eval_to_move(const Position& position) {
+        return position.eval();
+    }
+
+    /**
+     * @brief Counts the leaves the given plies from the position, as
+     * `Perft::count` does without a cache.
+     */
+    template <typename T>
+    u64 count_leaves(const T& position, const i32 depth) {
+        if (depth == 0)
+            return 1;
+        if (position.is_over())
+            return 0;
+
+        MoveList moves = position.legal_moves();
+        if (depth == 1)
+            return moves.n_moves();
+
+        u64 n = 0;
+        for (const auto move: moves) {
+            T child = position;
+            child.make_move_unchecked(move);
+            n += count_leaves(child, depth - 1);
+        }
+
+        return n;
+    }
+
+    /**
+     * @brief Sums the evaluations of the positions the given plies from the
+     * position, each from the perspective of the side to move before it.
+     */
+    template <typename T>
+    i64 sum_leaf_evals(const T& position, const i32 depth) {
+        if (depth == 0 || position.is_over())
+            return eval_to_move(position);
+
+        i64 sum = 0;
+        for (const auto move: position.legal_moves()) {
+            T child = position;
+            child.make_move_unchecked(move);
+            sum += child.is_pov_turn() == position.is_pov_turn()
+                ? sum_leaf_evals(child, depth - 1)
+                : -sum_leaf_evals(child, depth - 1);
+        }
+
+        return sum;
+    }
+
+    /**
+     * @brief Walks the tree from the start with one position type, returning
+     * the fastest times in milliseconds to count leaves and to sum their
+     * evaluations, with the count and the sum.
+     */
+    template <typename T>
+    std::tuple<f64, f64, u64, i64> time_walks(const i32 depth, const i32 nRounds) {
+        f64 countTime   = 1e300;
+        f64 evalTime    = 1e300;
+        u64 nLeaves     = 0;
+        i64 evalSum     = 0;
+        for (i32 round = 0; round < nRounds; round++) {
+            auto start  = std::chrono::steady_clock::now();
+            nLeaves     = count_leaves(T(), depth);
+            countTime   = std::min(countTime, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            start       = std::chrono::steady_clock::now();
+            evalSum     = sum_leaf_evals(T(), depth);
+            evalTime    = std::min(evalTime, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        return std::tuple(countTime, evalTime, nLeaves, evalSum);
+    }
+
+    /**
+     * @brief Sows every move with one kernel, returning the time taken in
+     * milliseconds and adding the boards to the checksum.
+     */
+    template <bool (Side::*kernel)(u8, Side&)>
+    f64 time_sowing(const std::vector<Sow>& sows, u64& checksum) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& sow: sows) {
+            Side        user    = sow.user;
+            Side        op      = sow.op;
+            const bool  isChain = (user.*kernel)(sow.move, op);
+            checksum += (user.bits() ^ op.bits()) + isChain;
+        }
+
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+std::vector<Game> Bench::get_positions(const std::span<const str> positions) {
+    std::vector<Game> games;
+
+    for (const auto moves: positions) {
+        // Replay the position's moves from the start.
+        Game                game;
+        std::istringstream  toks(moves);
+        u64                 move = 0;
+        while (toks >> move)
+            game.make_move(move);
+
+        games.push_back(game);
+    }
+
+    return games;
+}
+
+std::vector<Game> Bench::get_openings(const i32 plies) {
+    std::vector<Game> games = { Game() };
+
+    for (i32 ply = 0; ply < plies; ply++) {
+        std::vector<Game> next;
+        for (const auto& game: games) {
+            if (game.is_over())
+                continue;
+
+            for (const auto move: game.legal_moves()) {
+                Game child = game;
+                child.make_move_unchecked(move);
+                next.push_back(child);
+            }
+        }
+        games = std::move(next);
+    }
+
+    return games;
+}
+
+u64 Bench::search(const i32 depth, const std::span<const str> positions) {
+    const auto      games   = get_positions(positions);
+    AI              ai;
+    f64             time    = 0.0;
+    u64             nodes   = 0;
+    Search::Stats   stats   = {};
+    ai.set_solver_stones(0);
+
+    std::println("Searching {} positions to depth {}:", games.size(), depth);
+    std::println("{:>8} {:>6} {:>8} {:>12} {:>10} {:>12}", "Position", "Move", "Score", "Nodes", "Time (ms)", "NPS");
+    for (size i = 0; i < games.size(); i++) {
+        // Search every position from an empty table so the count doesn't depend on order.
+        ai.get_table().clear();
+
+        const auto start        = std::chrono::steady_clock::now();
+        const auto result       = ai.find_move(games[i], AI::Limits{ depth, 0, 0 });
+        const f64  positionTime = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+        time    += positionTime;
+        nodes   += result.nodes;
+        stats.add(result.stats);
+
+        std::println(
+            "{:>8} {:>6} {:>8} {:>12} {:>10.0f} {:>12.0f}",
+            i + 1, result.move, result.score, result.nodes, positionTime, result.nodes / std::max(positionTime / 1000.0, 1e-6)
+        );
+    }
+
+    std::println("Nodes:       {}", nodes);
+    std::println("Time:        {:.0f} ms", time);
+    std::println("NPS:         {:.0f}", nodes / std::max(time / 1000.0, 1e-6));
+    if constexpr (Search::STATS)
+        std::println(
+            "Cutoffs:     {} ({:.1f}% on the first move)",
+            stats.n_cutoffs(), 100.0 * stats.cutoffs[0] / std::max<u64>(stats.n_cutoffs(), 1)
+        );
+
+    return nodes;
+}
+
+void Bench::smp(const i32 depth) {
+    const auto games = get_positions();
+
+    std::println("Time to depth {} over {} positions:", depth, games.size());
+    std::println(
+        "{:>8} {:>8} {:>10} {:>12} {:>12} {:>8} {:>8}",
+        "Mode", "Threads", "Time (ms)", "Nodes", "NPS", "Speedup", "Moves"
+    );
+
+    for (const auto mode: { AI::Mode::LAZY_SMP, AI::Mode::YBWC }) {
+        std::vector<AI::Result> baseResults;
+        f64                     baseTime    = 0.0;
+
+        for (const auto nThreads: SMP_THREADS) {
+            std::vector<AI::Result> results;
+            AI                      ai;
+            f64                     time    = 0.0;
+            u64                     nodes   = 0;
+            ai.set_threads(nThreads);
+            ai.set_mode(mode);
+            ai.set_solver_stones(0);
+
+            for (const auto& game: games) {
+                // Search every position from an empty table.
+                ai.get_table().clear();
+
+                const auto start    = std::chrono::steady_clock::now();
+                const auto result   = ai.find_move(game, AI::Limits{ depth, 0, 0 });
+                time    += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+                nodes   += result.nodes;
+                results.push_back(result);
+            }
+
+            if (nThreads == 1) {
+                baseTime    = time;
+                baseResults = results;
+            }
+
+            // Check whether the moves and scores match the single thread's.
+            bool isSame = true;
+            for (size i = 0; i < results.size(); i++)
+                isSame &= results[i].move == baseResults[i].move && results[i].score == baseResults[i].score;
+
+            std::println(
+                "{:>8} {:>8} {:>10.0f} {:>12} {:>12.0f} {:>8.2f} {:>8}",
+                AI::mode_name(mode), nThreads, time, nodes, nodes / (time / 1000.0), baseTime / time,
+                isSame ? "same" : "differ"
+            );
+        }
+    }
+}
+
+void Bench::drivers(const i32 depth) {
+    const auto games = get_positions();
+
+    std::println("Time to depth {} over {} positions:", depth, games.size());
+    std::println(
+        "{:>10} {:>10} {:>12} {:>12} {:>8} {:>8}",
+        "Driver", "Time (ms)", "Nodes", "NPS", "Speedup", "Moves"
+    );
+
+    std::vector<AI::Result> baseResults;
+    f64                     baseTime    = 0.0;
+
+    for (const auto driver: DRIVERS) {
+        std::vector<AI::Result> results;
+        AI                      ai;
+        f64                     time    = 0.0;
+        u64                     nodes   = 0;
+        ai.set_driver(driver);
+        ai.set_solver_stones(0);
+
+        for (const auto& game: games) {
+            // Search every position from an empty table.
+            ai.get_table().clear();
+
+            const auto start    = std::chrono::steady_clock::now();
+            const auto result   = ai.find_move(game, AI::Limits{ depth, 0, 0 });
+            time    += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+            nodes   += result.nodes;
+            results.push_back(result);
+        }
+
+        if (driver == DRIVERS[0]) {
+            baseTime    = time;
+            baseResults = results;
+        }
+
+        // Check whether the moves and scores match the full-window search's.
+        bool isSame = true;
+        for (size i = 0; i < results.size(); i++)
+            isSame &= results[i].move == baseResults[i].move && results[i].score == baseResults[i].score;
+
+        std::println(
+            "{:>10} {:>10.0f} {:>12} {:>12.0f} {:>8.2f} {:>8}",
+            AI::driver_name(driver), time, nodes, nodes / (time / 1000.0), baseTime / time,
+            isSame ? "same" : "differ"
+        );
+    }
+}
+
+void Bench::stop_latency() {
+    auto games = get_positions();
+    for (const auto& game: get_positions(ENDGAMES))
+        games.push_back(game);
+
+    std::println("Stop to result over {} positions:", games.size());
+    std::println(
+        "{:>10} {:>12} {:>12} {:>10}",
+        "Delay (ms)", "Mean (us)", "Max (us)", "Min depth"
+    );
+
+    for (const auto delay: STOP_DELAYS) {
+        AI  ai;
+        f64 total       = 0.0;
+        f64 max         = 0.0;
+        i32 minDepth    = AI::MAX_DEPTH;
+        ai.set_solver_stones(0);
+
+        for (const auto& game: games) {
+            ai.get_table().clear();
+
+            // The search thread stamps the end, which the wait then publishes.
+            std::chrono::steady_clock::time_point end;
+            ai.start_search(game, AI::Limits{ AI::MAX_DEPTH, 0, 0 }, {}, [&end](const AI::Result&){
+                end = std::chrono::steady_clock::now();
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+            const auto  start   = std::chrono::steady_clock::now();
+            ai.stop();
+            const auto  result  = ai.wait();
+
+            // A search that ended on its own took no time to stop.
+            const f64 latency = std::max(std::chrono::duration<f64, std::micro>(end - start).count(), 0.0);
+            total       += latency;
+            max         = std::max(max, latency);
+            minDepth    = std::min(minDepth, result->depth);
+        }
+
+        std::println(
+            "{:>10} {:>12.1f} {:>12.1f} {:>10}",
+            delay, total / static_cast<f64>(games.size()), max, minDepth
+        );
+    }
+}
+
+void Bench::server(const ServerLoad& load) {
+    i32 fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::println("Failed to make a socket pair.");
+        return;
+    }
+
+    Server      server(load.nWorkers, SERVER_MB);
+    std::thread serving([&](){ server.serve(fds[1]); });
+
+    std::vector<Search::Clock::time_point>  sent(load.nGames);
+    std::vector<f64>                        latencies;
+    size                                    nErrors     = 0;
+    size                                    nDeadlines  = 0;
+    const std::string                       go          = load.deadline > 0
+        ? std::format("go movetime {} deadline {}", load.movetime, load.deadline)
+        : std::format("go movetime {}", load.movetime);
+    const auto send = [&](const std::string& line){
+        const std::string out = line + '\n';
+        for (size done = 0; done < out.size(); ) {
+            const auto n = ::send(fds[0], out.data() + done, out.size() - done, MSG_NOSIGNAL);
+            if (n <= 0)
+                return;
+            done += static_cast<size>(n);
+        }
+    };
+
+    std::println(
+        "Serving {} searches of {} ms over {} games on {} workers{}...",
+        load.nRequests, load.movetime, load.nGames, server.n_workers(),
+        load.deadline > 0 ? std::format(" with a {} ms deadline", load.deadline) : ""
+    );
+
+    // Every game starts with a search; each answer sends the next.
+    const auto start = Search::Clock::now();
+    for (size i = 0; i < load.nGames; i++) {
+        sent[i] = Search::Clock::now();
+        send(std::format("{} new", i));
+        send(std::format("{} {}", i, go));
+    }
+
+    std::string buffer;
+    size        nAnswered   = 0;
+    size        nSent       = load.nGames;
+    while (nAnswered < nSent) {
+        char        chunk[4096];
+        const auto  n = ::read(fds[0], chunk, sizeof(chunk));
+        if (n <= 0)
+            break;
+        buffer.append(chunk, static_cast<size>(n));
+
+        for (size newline = buffer.find('\n'); newline != std::string::npos; newline = buffer.find('\n')) {
+            std::istringstream  toks(buffer.substr(0, newline));
+            size                id      = 0;
+            std::string         answer;
+            std::string         arg;
+            buffer.erase(0, newline + 1);
+            toks >> id >> answer >> arg;
+
+            // Only the searches are timed; moves and new games just say "ok".
+            if (answer == "ok")
+                continue;
+            nAnswered++;
+            latencies.push_back(std::chrono::duration<f64, std::milli>(Search::Clock::now() - sent[id]).count());
+
+            if (nSent >= load.nRequests)
+                continue;
+            if (answer == "bestmove") {
+                send(std::format("{} move {}", id, arg));
+            } else {
+                // Start over from the end of a game, or a missed deadline.
+                nErrors     += arg != "game";
+                nDeadlines  += arg == "deadline";
+                send(std::format("{} new", id));
+            }
+            sent[id] = Search::Clock::now();
+            send(std::format("{} {}", id, go));
+            nSent++;
+        }
+    }
+    const f64 time = std::chrono::duration<f64>(Search::Clock::now() - start).count();
+
+    send("quit");
+    serving.join();
+    ::close(fds[0]);
+
+    std::ranges::sort(latencies);
+    const auto percentile = [&](const f64 p){
+        return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, static_cast<size>(p * static_cast<f64>(latencies.size())))];
+    };
+    std::println("Requests:    {} in {:.2f} s", latencies.size(), time);
+    std::println("Throughput:  {:.1f} requests/s", static_cast<f64>(latencies.size()) / time);
+    std::println("Latency:     p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms", percentile(0.50), percentile(0.99), latencies.empty() ? 0.0 : latencies.back());
+    std::println("Errors:      {} ({} missed deadlines)", nErrors, nDeadlines);
+}
+
+i32 Bench::quiescence(const AI::Limits& limits, const AI::Limits& plainLimits) {
+    const auto          openings    = get_openings(QS_PLIES);
+    i32                 total       = 0;
+    std::array<size, 3> outcomes    = {};
+    std::array<f64, 2>  depths      = {};
+    std::array<size, 2> nMoves      = {};
+
+    std::println("Self-play from {} openings, quiescence against none:", openings.size());
+    std::println("{:>8} {:>12} {:>12}", "Opening", "QS first", "QS second");
+
+    for (size i = 0; i < openings.size(); i++) {
+        std::array<i32, 2> diffs = {};
+
+        // Play each opening from both sides.
+        for (const bool isQsFirst: { true, false }) {
+            std::array<AI, 2>   ais;
+            Game                game    = openings[i];
+            const bool          isQsPov = isQsFirst == game.is_pov_turn();
+            ais[0].set_solver_stones(0);
+            ais[1].set_solver_stones(0);
+            ais[1].set_quiescence(false);
+
+            while (!game.is_over()) {
+                const size  side    = game.is_pov_turn() == isQsPov ? 0 : 1;
+                const auto  result  = ais[side].find_move(game, side == 0 ? limits : plainLimits);
+                depths[side] += result.depth;
+                nMoves[side]++;
+                game.make_move(result.move);
+            }
+
+            // Score the game by the final stone difference for the quiescence side.
+            const auto  [a, b]  = game.get_sides();
+            const i32   diff    = isQsPov
+                ? a.mancala() - b.mancala()
+                : b.mancala() - a.mancala();
+            diffs[isQsFirst ? 0 : 1] = diff;
+            total += diff;
+            outcomes[diff > 0 ? 0 : diff == 0 ? 1 : 2]++;
+        }
+
+        std::println("{:>8} {:>12} {:>12}", i + 1, diffs[0], diffs[1]);
+    }
+
+    std::println("Wins/draws/losses: {}/{}/{}", outcomes[0], outcomes[1], outcomes[2]);
+    std::println("Stone difference:  {:+}", total);
+    std::println(
+        "Average depth:     {:.1f} with quiescence, {:.1f} without",
+        depths[0] / std::max<f64>(nMoves[0], 1), depths[1] / std::max<f64>(nMoves[1], 1)
+    );
+
+    return total;
+}
+
+void Bench::tablebase(AI& ai, const i32 depth) {
+    const auto  games   = get_positions();
+    AI          plain;
+    const u32   stones  = ai.get_solver_stones();
+    plain.set_threads(ai.get_threads());
+    plain.set_mode(ai.get_mode());
+
+    // Compare the searches, not the solver.
+    plain.set_solver_stones(0);
+    ai.set_solver_stones(0);
+
+    std::println("Time to depth {} with a {}-stone tablebase:", depth, ai.get_tablebase().max_stones());
+    std::println(
+        "{:>8} {:>6} {:>10} {:>12} {:>10} {:>12} {:>12} {:>8} {:>8}",
+        "Position", "Stones", "Base (ms)", "Base nodes", "TB (ms)", "TB nodes", "TB probes", "Hit rate", "Score"
+    );
+
+    f64 baseTime    = 0.0;
+    f64 tbTime      = 0.0;
+    u64 nProbes     = 0;
+    u64 nHits       = 0;
+    for (size i = 0; i < games.size(); i++) {
+        // Search from empty tables so neither run helps the other.
+        plain.get_table().clear();
+        ai.get_table().clear();
+
+        const auto base = plain.find_move(games[i], AI::Limits{ depth, 0, 0 });
+        const auto tb   = ai.find_move(games[i], AI::Limits{ depth, 0, 0 });
+        baseTime    += base.time;
+        tbTime      += tb.time;
+        nProbes     += tb.tbProbes;
+        nHits       += tb.tbHits;
+
+        std::println(
+            "{:>8} {:>6} {:>10} {:>12} {:>10} {:>12} {:>12} {:>7.1f}% {:>8}",
+            i + 1, games[i].n_pit_stones(), base.time, base.nodes, tb.time, tb.nodes, tb.tbProbes,
+            tb.tbProbes > 0 ? 100.0 * tb.tbHits / tb.tbProbes : 0.0, tb.score
+        );
+    }
+
+    std::println(
+        "Total: {:.0f} ms without, {:.0f} ms with the tablebase; {} of {} probes hit ({:.1f}%).",
+        baseTime, tbTime, nHits, nProbes, nProbes > 0 ? 100.0 * nHits / nProbes : 0.0
+    );
+    ai.set_solver_stones(stones);
+}
+
+void Bench::position(const i32 depth) {
+    std::println("Walking every line {} plies from the start, best of {}:", depth, POSITION_ROUNDS);
+
+    const auto [gameCount, gameEval, gameLeaves, gameSum] = time_walks<Game>(depth, POSITION_ROUNDS);
+    const auto [posCount, posEval, posLeaves, posSum]     = time_walks<Position>(depth, POSITION_ROUNDS);
+
+    std::println("{:>9} {:>11} {:>12} {:>10} {:>16}", "Type", "Perft (ms)", "Leaves", "Eval (ms)", "Eval sum");
+    std::println("{:>9} {:>11.1f} {:>12} {:>10.1f} {:>16}", "game", gameCount, gameLeaves, gameEval, gameSum);
+    std::println("{:>9} {:>11.1f} {:>12} {:>10.1f} {:>16}", "position", posCount, posLeaves, posEval, posSum);
+    std::println("Speedup:     {:.2f}x perft, {:.2f}x eval", gameCount / posCount, gameEval / posEval);
+    if (gameLeaves != posLeaves || gameSum != posSum)
+        std::println("The types' walks differ.");
+}
+
+void Bench::sowing() {
+    // Gather every move first so both kernels sow the same ones.
+    std::vector<Sow> sows;
+    for (const auto& game: get_openings(SOW_PLIES)) {
+        if (game.is_over())
+            continue;
+
+        const auto [user, op] = game.get_turn_user_opp();
+        for (const auto move: game.legal_moves())
+            sows.push_back({ user, op, move });
+    }
+
+    std::println("Sowing {} moves from every position {} plies from the start, best of {}:", sows.size(), SOW_PLIES, SOW_ROUNDS);
+
+    // Alternate the kernels so neither gets a warmer machine.
+    f64 tableTime       = 1e300;
+    f64 shiftsTime      = 1e300;
+    u64 tableChecksum   = 0;
+    u64 shiftsChecksum  = 0;
+    for (i32 round = 0; round < SOW_ROUNDS; round++) {
+        tableTime   = std::min(tableTime, time_sowing<&Side::sow_table>(sows, tableChecksum));
+        shiftsTime  = std::min(shiftsTime, time_sowing<&Side::sow_shifts>(sows, shiftsChecksum));
+    }
+
+    std::println("{:>8} {:>10} {:>10}", "Kernel", "Time (ms)", "ns/move");
+    std::println("{:>8} {:>10.2f} {:>10.2f}", "table", tableTime, tableTime * 1e6 / std::max<size>(sows.size(), 1));
+    std::println("{:>8} {:>10.2f} {:>10.2f}", "shifts", shiftsTime, shiftsTime * 1e6 / std::max<size>(sows.size(), 1));
+    std::println("Speedup:     {:.2f}x ({} is built in)", shiftsTime / tableTime, Side::SOW_TABLES ? "table" : "shifts");
+    if (tableChecksum != shiftsChecksum)
+        std::println("The kernels' boards differ; run \"bench sow verify\".");
+}
+
+bool Bench::verify_sowing() {
+    u64 nChecked    = 0;
+    u64 nDiffering  = 0;
+
+    // Only the sown pit, the pit the last stone lands in, and the pit across
+    // from it change what a move does beyond adding stones, so try every way
+    // to fill those three with the rest of the stones in the mancalas.
+    for (u8 move = 1; move <= N_PITS; move++) {
+        for (u64 nStones = 1; nStones <= N_STONES; nStones++) {
+            for (u8 last = 1; last <= N_PITS; last++) {
+                const u64 nLastMax = last == move ? 0 : N_STONES - nStones;
+                for (u64 nLast = 0; nLast <= nLastMax; nLast++) {
+                    for (u64 nAcross = 0; nAcross <= N_STONES - nStones - nLast; nAcross++) {
+                        std::array<u8, N_PITS> userPits    = {};
+                        std::array<u8, N_PITS> opPits      = {};
+                        userPits[move - 1]          = static_cast<u8>(nStones);
+                        userPits[last - 1]         += static_cast<u8>(nLast);
+                        opPits[N_PITS - last]       = static_cast<u8>(nAcross);
+
+                        const u64 nMancalas = N_STONES - nStones - nLast - nAcross;
+                        const Sow sow       = {
+                            Side::from_pits(userPits, static_cast<u8>(nMancalas / 2), true),
+                            Side::from_pits(opPits, static_cast<u8>(nMancalas - nMancalas / 2), false),
+                            move,
+                        };
+                        nChecked++;
+                        nDiffering += !is_same_sowing(sow);
+                    }
+                }
+            }
+        }
+    }
+    std::println("Pit contents:     {} sowings checked, {} differ", nChecked, nDiffering);
+
+    // Then every move actually played near the start.
+    const u64 nContentDiffering = nDiffering;
+    nChecked    = 0;
+    nDiffering  = 0;
+    verify_sowing_from(Game(), SOW_VERIFY_PLIES, nChecked, nDiffering);
+    std::println("Reachable to {:>2}:  {} sowings checked, {} differ", SOW_VERIFY_PLIES, nChecked, nDiffering);
+
+    const bool isOk = nContentDiffering == 0 && nDiffering == 0;
+    if (isOk)
+        std::println("The table and shift kernels agree.");
+    else
+        std::println("The table and shift kernels differ.");
+
+    return isOk;
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "ai.h"
+#include "def.h"
+#include "game.h"
+#include "position.h"
+
+class Bench {
+public:
+    /**
+     * @brief The default depth for the search benchmark.
+     */
+    static constexpr inline i32 SEARCH_DEPTH = 20;
+
+    /**
+     * @brief The default depth for the endgame benchmark.
+     */
+    static constexpr inline i32 ENDGAME_DEPTH = 24;
+
+    /**
+     * @brief The default depth for the thread scaling benchmark.
+     */
+    static constexpr inline i32 SMP_DEPTH = 18;
+
+    /**
+     * @brief The default depth for the root search driver benchmark.
+     */
+    static constexpr inline i32 DRIVERS_DEPTH = 20;
+
+    /**
+     * @brief The default time per move in milliseconds for the quiescence self-play benchmark.
+     */
+    static constexpr inline u64 QS_MOVETIME = 100;
+
+    /**
+     * @brief The plies from the start position of the quiescence self-play
+     * benchmark's openings.
+     */
+    static constexpr inline i32 QS_PLIES = 2;
+
+    /**
+     * @brief The default depth for the tablebase benchmark.
+     */
+    static constexpr inline i32 TB_DEPTH = 18;
+
+    /**
+     * @brief The default depth for the position type benchmark.
+     */
+    static constexpr inline i32 POSITION_DEPTH = 10;
+
+    /**
+     * @brief The number of times the position type benchmark walks the tree
+     * with each type, keeping the fastest.
+     */
+    static constexpr inline i32 POSITION_ROUNDS = 3;
+
+    /**
+     * @brief The plies from the start position of the positions the sowing
+     * benchmark plays every move of.
+     */
+    static constexpr inline i32 SOW_PLIES = 6;
+
+    /**
+     * @brief The number of times the sowing benchmark times each kernel,
+     * keeping the fastest.
+     */
+    static constexpr inline i32 SOW_ROUNDS = 50;
+
+    /**
+     * @brief The plies from the start position up to which the sowing check
+     * plays every move with both kernels.
+     */
+    static constexpr inline i32 SOW_VERIFY_PLIES = 10;
+
+    /**
+     * @brief The thread counts compared by the thread scaling benchmark.
+     */
+    static constexpr inline std::array<size, 5> SMP_THREADS = { 1, 2, 4, 8, 16 };
+
+    /**
+     * @brief How long the stop latency benchmark lets each search run before
+     * stopping it, in milliseconds.
+     */
+    static constexpr inline std::array<u64, 3> STOP_DELAYS = { 5, 20, 100 };
+
+    /**
+     * @brief The options of the server load generator.
+     */
+    struct ServerLoad {
+        /**
+         * @brief The number of games played at once, each with one request
+         * outstanding at a time.
+         */
+        size nGames;
+
+        /**
+         * @brief The number of searches to time.
+         */
+        size nRequests;
+
+        /**
+         * @brief The number of server workers.
+         */
+        size nWorkers;
+
+        /**
+         * @brief The time budget of each search in milliseconds.
+         */
+        u64 movetime;
+
+        /**
+         * @brief The deadline of each search in milliseconds, or 0 for none.
+         */
+        u64 deadline;
+    };
+
+    /**
+     * @brief The default options of the server load generator.
+     */
+    static constexpr inline ServerLoad SERVER_LOAD = { 64, 2000, 4, 10, 0 };
+
+    /**
+     * @brief The size of the server load generator's shared table in megabytes.
+     */
+    static constexpr inline size SERVER_MB = 64;
+
+    /**
+     * @brief The root search drivers compared by the driver benchmark, the
+     * first being the baseline.
+     */
+    static constexpr inline std::array<AI::Driver, 3> DRIVERS = {
+        AI::Driver::FULL_WINDOW,
+        AI::Driver::ASPIRATION,
+        AI::Driver::MTDF,
+    };
+
+    /**
+     * @brief The benchmark positions, as moves played from the start position.
+     *
+     * @details Covers openings, chain-heavy and capture-heavy middlegames, and
+     * endgames with few stones left in the pits.
+     */
+    static constexpr inline std::array<str, 8> POSITIONS = {
+        "",
+        "3 6",
+        "1 2 3 4",
+        "5 5 1 2 2 5 1 5 1 5 3 5 2 4 6 3 5 2 6 6 2 3 1 2 3 6 1 4 3 3",
+        "5 5 6 4 2 4 5 3 3 2 4 1 2",
+        "4 3 6 1 2 5 3 5 2 1 5 2 1 5 4 1 4 5 6 4 1 5 6 6 3 3 2 2",
+        "3 6 1 3 2 2 3 1 5 4 2 5 3 1 4 6 6 4 2 1 3 1",
+        "2 2 1 5 5 4 2 6 3 4 2 5 4 1 3 2 1 5 5 2 2 4 1 3 1 6 3 2 6 5 1 1 3 4 5 6 4 4 2 2",
+    };
+
+    /**
+     * @brief The endgame benchmark positions, as moves played from the start
+     * position.
+     *
+     * @details Self-play games stopped with at most 24 stones left in the
+     * pits, where the mancalas come close to settling the result.
+     */
+    static constexpr inline std::array<str, 8> ENDGAMES = {
+        "3 6 2 3 4 2 5 5 6 2 3 1 5 2 1 4 3 2 4 3 2 6 3 4 2 2 5 1 5 3 1",
+        "2 4 6 5 5 3 2 4 4 2 3 3 2 6 6 3 2 5 2 5 2 4 1 2 1 1 2",
+        "2 4 3 6 5 1 2 4 6 1 2 4 1 3 2 5 6 2 2 4 1 4 1 2 1 3 1",
+        "4 2 4 6 1 5 5 1 6 1 4 2 3 3 2 4 1 2 1 5 1 4 5",
+        "3 3 1 2 5 1 6 1 3 3 4 5 1 2 2 1 1",
+        "2 6 5 2 1 5 6 1 2 1 3 6 1 5 2 3 2 1 4 2 4 2 3 5 1 2 3 6",
+        "3 6 6 4 5 6 5 4 1 2 6 2 6 1 3 4 1 2 1 4 2 1 3 1 1 4 2",
+        "1 3 4 1 5 5 4 6 1 5 3 4 2 3 1 6 4 1 2 1 5",
+    };
+
+    /**
+     * @brief Returns the given benchmark positions, the main ones by default.
+     */
+    static std::vector<Game> get_positions(std::span<const str> positions = POSITIONS);
+
+    /**
+     * @brief Returns every position the given number of plies from the start.
+     */
+    static std::vector<Game> get_openings(i32 plies);
+
+    /**
+     * @brief Searches every given position to the given depth on one thread
+     * from an empty table, printing the nodes, time, and nodes per second.
+     *
+     * @details The total node count is a signature of the search's behavior:
+     * builds that search the same way give the same count on any hardware.
+     *
+     * @return The total node count.
+     */
+    static u64 search(i32 depth, std::span<const str> positions = POSITIONS);
+
+    /**
+     * @brief Measures the time to reach the given depth on every position with
+     * each thread count in `SMP_THREADS` and each parallel mode, and prints the
+     * nodes per second and speedup over one thread.
+     */
+    static void smp(i32 depth);
+
+    /**
+     * @brief Measures the time to reach the given depth on every position on
+     * one thread with each driver in `DRIVERS`, and prints the nodes and
+     * speedup over the full-window search.
+     */
+    static void drivers(i32 depth);
+
+    /**
+     * @brief Plays every opening of `QS_PLIES` plies out twice between a
+     * search with quiescence and one without, swapping sides, and prints the
+     * wins, draws, and losses, the total stone difference, and the average
+     * depth reached.
+     *
+     * @return The sum of the quiescence side's stone differences.
+     */
+    static i32 quiescence(const AI::Limits& limits, const AI::Limits& plainLimits);
+
+    /**
+     * @brief Times `Game` against `Position` walking every line the given
+     * number of plies from the start, once counting the leaves as perft does
+     * and once summing their evaluations as a search would see them.
+     */
+    static void position(i32 depth);
+
+    /**
+     * @brief Measures the time from `AI::stop` to the result of a search
+     * started by `AI::start_search` with no limits, over the main and endgame
+     * positions, after each of `STOP_DELAYS`.
+     */
+    static void stop_latency();
+
+    /**
+     * @brief Plays games against a `Server` over a socket pair, each game
+     * asking for a search, playing the answer, and asking again, and reports
+     * requests per second and the latency percentiles of the searches.
+     */
+    static void server(const ServerLoad& load);
+
+    /**
+     * @brief Times `Side::sow_table` against `Side::sow_shifts` on every move
+     * of every position `SOW_PLIES` from the start.
+     */
+    static void sowing();
+
+    /**
+     * @brief Checks that `Side::sow_table` and `Side::sow_shifts` agree on
+     * every pit and stone count, with every content of the pits a last stone
+     * can capture with, and on every move up to `SOW_VERIFY_PLIES` from the
+     * start.
+     *
+     * @return `true` if they always agree, `false` if not.
+     */
+    static bool verify_sowing();
+
+    /**
+     * @brief Searches every position to the given depth with and without the
+     * AI's tablebase, printing the time taken and how often probes hit.
+     */
+    static void tablebase(AI& ai, i32 depth);
+};
@@ -0,0 +1,160 @@
+#include "book.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "ai.h"
+
+Book::Book() : file(), entries(nullptr), nEntries(0), plies(0) {
+
+}
+
+bool Book::generate(const std::string& path, const u32 plies, const i32 depth, const size nThreads) {
+    // Expand every line from the start, keeping positions that aren't over.
+    std::vector<Game>   frontier    = { Game() };
+    std::vector<Entry>  entries;
+    for (u32 ply = 0; ply <= plies; ply++) {
+        std::vector<Game> next;
+        for (const auto& game: frontier) {
+            if (game.is_over())
+                continue;
+
+            const auto [a, b] = game.get_sides();
+            entries.push_back(Entry{ a.bits(), b.bits(), 0, 0, 0, 0 });
+            if (ply == plies)
+                continue;
+
+            for (const auto move: game.legal_moves()) {
+                Game child = game;
+                child.make_move_unchecked(move);
+                next.push_back(child);
+            }
+        }
+
+        // Drop positions reached by more than one line.
+        std::sort(next.begin(), next.end(), [](const Game& x, const Game& y){
+            const auto [xa, xb] = x.get_sides();
+            const auto [ya, yb] = y.get_sides();
+            return std::tuple(xa.bits(), xb.bits()) < std::tuple(ya.bits(), yb.bits());
+        });
+        next.erase(std::unique(next.begin(), next.end(), [](const Game& x, const Game& y){
+            const auto [xa, xb] = x.get_sides();
+            const auto [ya, yb] = y.get_sides();
+            return xa.bits() == ya.bits() && xb.bits() == yb.bits();
+        }), next.end());
+        frontier = std::move(next);
+    }
+
+    // Lines of different lengths can still meet.
+    std::sort(entries.begin(), entries.end(), is_before);
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& x, const Entry& y){
+        return x.a == y.a && x.b == y.b;
+    }), entries.end());
+
+    // Search the positions, each thread with its own AI and table.
+    std::atomic<size>           next    = 0;
+    std::vector<std::thread>    threads;
+    const auto work = [&](){
+        AI ai;
+        for (size i = next++; i < entries.size(); i = next++) {
+            // Start from an empty table so results don't depend on the order searched.
+            ai.get_table().clear();
+
+            Entry&      entry   = entries[i];
+            const auto  result  = ai.find_move(
+                Game(Side::from_bits(entry.a), Side::from_bits(entry.b)),
+                AI::Limits{ depth, 0, 0 }
+            );
+
+            entry.score = result.score;
+            entry.move  = static_cast<u8>(result.move);
+            entry.depth = static_cast<u8>(result.depth);
+        }
+    };
+
+    const size nWorkers = std::clamp<size>(nThreads, 1, entries.size());
+    for (size i = 1; i < nWorkers; i++)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread: threads)
+        thread.join();
+
+    // Write the header and the entries.
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    const Header header = { MAGIC, VERSION, plies, static_cast<u32>(depth), entries.size() };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char*>(entries.data()),
+        static_cast<std::streamsize>(entries.size() * sizeof(Entry))
+    );
+
+    return static_cast<bool>(out);
+}
+
+bool Book::load(const std::string& path) {
+    unload();
+    if (!file.open(path))
+        return false;
+
+    // Check that the file is a complete book.
+    const size      fileSize    = file.size_bytes();
+    const Header&   header      = *reinterpret_cast<const Header*>(file.data());
+    if (fileSize < sizeof(Header)
+        || header.magic != MAGIC
+        || header.version != VERSION
+        || fileSize != sizeof(Header) + header.nEntries * sizeof(Entry)
+    ) {
+        file.close();
+        return false;
+    }
+
+    entries     = reinterpret_cast<const Entry*>(file.data() + sizeof(Header));
+    nEntries    = header.nEntries;
+    plies       = header.plies;
+
+    return true;
+}
+
+void Book::unload() {
+    file.close();
+    entries     = nullptr;
+    nEntries    = 0;
+    plies       = 0;
+}
+
+bool Book::is_loaded() const {
+    return entries != nullptr;
+}
+
+size Book::n_entries() const {
+    return nEntries;
+}
+
+u32 Book::n_plies() const {
+    return plies;
+}
+
+std::optional<Book::Entry> Book::probe(const Game& game) const {
+    if (!is_loaded())
+        return std::nullopt;
+
+    const auto  [a, b]  = game.get_sides();
+    const Entry key     = { a.bits(), b.bits(), 0, 0, 0, 0 };
+    const auto  it      = std::lower_bound(entries, entries + nEntries, key, is_before);
+
+    if (it != entries + nEntries && it->a == key.a && it->b == key.b)
+        return *it;
+    else
+        return std::nullopt;
+}
+
+bool Book::is_before(const Entry& x, const Entry& y) {
+    return x.a < y.a || (x.a == y.a && x.b < y.b);
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "def.h"
+#include "game.h"
+#include "mappedfile.h"
+
+class Book {
+public:
+    struct Entry {
+        /**
+         * @brief The position's PoV side's bits.
+         */
+        u64 a;
+
+        /**
+         * @brief The position's upper side's bits.
+         */
+        u64 b;
+
+        /**
+         * @brief The evaluation found for the position.
+         */
+        i32 score;
+
+        /**
+         * @brief The best move found.
+         */
+        u8 move;
+
+        /**
+         * @brief The depth the position was searched to.
+         */
+        u8 depth;
+
+        /**
+         * @brief Unused.
+         */
+        u16 reserved;
+    };
+
+    /**
+     * @brief The default number of plies from the start to build a book for.
+     */
+    static constexpr inline u32 DEFAULT_PLIES = 4;
+
+    /**
+     * @brief The default depth to search book positions to.
+     */
+    static constexpr inline i32 DEFAULT_DEPTH = 18;
+
+private:
+    /**
+     * @brief The file's header.
+     */
+    struct Header {
+        /**
+         * @brief Always `MAGIC`.
+         */
+        u32 magic;
+
+        /**
+         * @brief Always `VERSION`.
+         */
+        u32 version;
+
+        /**
+         * @brief The number of plies from the start covered.
+         */
+        u32 plies;
+
+        /**
+         * @brief The depth the positions were searched to.
+         */
+        u32 depth;
+
+        /**
+         * @brief The number of entries stored after the header.
+         */
+        u64 nEntries;
+    };
+
+    /**
+     * @brief Identifies a book file ("RHBK").
+     */
+    static constexpr inline u32 MAGIC = 0x4B424852;
+
+    /**
+     * @brief The file format version.
+     */
+    static constexpr inline u32 VERSION = 1;
+
+    /**
+     * @brief The loaded file.
+     */
+    MappedFile file;
+
+    /**
+     * @brief The stored entries, sorted by position.
+     */
+    const Entry* entries;
+
+    /**
+     * @brief The number of stored entries.
+     */
+    size nEntries;
+
+    /**
+     * @brief The number of plies from the start covered.
+     */
+    u32 plies;
+
+public:
+    Book();
+
+    Book(const Book&) = delete;
+
+    Book& operator=(const Book&) = delete;
+
+    /**
+     * @brief Searches every position up to the given number of plies from the
+     * start to the given depth and writes the results to the given file.
+     *
+     * @details Positions reached by more than one line are searched once. Each
+     * thread searches its share of the positions with its own AI.
+     *
+     * @return `true` on success, `false` if the file could not be written.
+     */
+    static bool generate(const std::string& path, u32 plies, i32 depth, size nThreads);
+
+    /**
+     * @brief Memory-maps the given book file, replacing any loaded one.
+     *
+     * @return `true` on success, `false` if the file is missing or invalid.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Unmaps the loaded file, if any.
+     */
+    void unload();
+
+    /**
+     * @brief Returns `true` if a book is loaded.
+     */
+    bool is_loaded() const;
+
+    /**
+     * @brief Returns the number of positions in the loaded book.
+     */
+    size n_entries() const;
+
+    /**
+     * @brief Returns the number of plies from the start covered, or 0 if none is loaded.
+     */
+    u32 n_plies() const;
+
+    /**
+     * @brief Returns the book's entry for the position, if it has one.
+     *
+     * @details Binary searches the mapped file.
+     */
+    std::optional<Entry> probe(const Game& game) const;
+
+private:
+    /**
+     * @brief Returns `true` if the first entry's position sorts before the second's.
+     */
+    static bool is_before(const Entry& x, const Entry& y);
+};
@@ -0,0 +1,12 @@
+#include "chainlist.h"
+
+// The frames and ends are left uninitialized since a list is made for every
+// node searched; only those below `nFrames` and `nSeen` are ever read.
+ChainList::ChainList() : nFrames(0), nSeen(0) {
+
+}
+
+void ChainList::moves(const std::span<u8> out) const {
+    for (size i = 0; i < nFrames; i++)
+        out[i] = frames[i].moves[frames[i].next - 1];
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "config.h"
+#include "def.h"
+#include "game.h"
+#include "movelist.h"
+#include "side.h"
+
+class ChainList {
+public:
+    /**
+     * @brief The most moves a chain can be played out to before it is ended
+     * where it stands.
+     */
+    static constexpr inline size MAX_LENGTH = 32;
+
+    /**
+     * @brief The most chain ends remembered to skip chains meeting them.
+     */
+    static constexpr inline size MAX_SEEN = 32;
+
+private:
+    /**
+     * @brief A position in the chain being played out, with its moves.
+     */
+    struct Frame {
+        /**
+         * @brief The PoV side, packed.
+         */
+        u64 a;
+
+        /**
+         * @brief The upper side, packed.
+         */
+        u64 b;
+
+        /**
+         * @brief The position's legal moves, in the order to play them.
+         */
+        std::array<u8, N_PITS> moves;
+
+        /**
+         * @brief The number of legal moves.
+         */
+        u8 nMoves;
+
+        /**
+         * @brief The index of the next move to play.
+         */
+        u8 next;
+    };
+
+    /**
+     * @brief The end of a chain already given out.
+     */
+    struct Seen {
+        /**
+         * @brief The PoV side, packed.
+         */
+        u64 a;
+
+        /**
+         * @brief The upper side, packed.
+         */
+        u64 b;
+
+        /**
+         * @brief The number of moves in the chain.
+         */
+        size length;
+    };
+
+    /**
+     * @brief The positions of the chain being played out, the first being the
+     * starting position.
+     */
+    std::array<Frame, MAX_LENGTH> frames;
+
+    /**
+     * @brief The number of frames.
+     */
+    size nFrames;
+
+    /**
+     * @brief The ends of the chains of more than one move given out so far.
+     */
+    std::array<Seen, MAX_SEEN> seen;
+
+    /**
+     * @brief The number of chain ends remembered.
+     */
+    size nSeen;
+
+public:
+    ChainList();
+
+    /**
+     * @brief Returns `true` if another position can be pushed.
+     */
+    inline bool can_push() const {
+        return nFrames < MAX_LENGTH;
+    }
+
+    /**
+     * @brief Continues the chain from the given position, which must follow
+     * the last move given by `advance`, with its moves in the order to play them.
+     */
+    inline void push(const Game& game, MoveList& moves) {
+        const auto  [a, b]  = game.get_sides();
+        Frame&      frame   = frames[nFrames++];
+        frame.a         = a.bits();
+        frame.b         = b.bits();
+        frame.nMoves    = static_cast<u8>(moves.n_moves());
+        frame.next      = 0;
+        std::copy(moves.begin(), moves.end(), frame.moves.begin());
+    }
+
+    /**
+     * @brief Plays the next move depth first, writing the resulting position
+     * and the number of moves from the starting position.
+     *
+     * @return `false` once every move has been played.
+     */
+    inline bool advance(Game& child, size& length) {
+        while (nFrames > 0) {
+            // Go back up once a position's moves have all been played.
+            Frame& top = frames[nFrames - 1];
+            if (top.next == top.nMoves) {
+                nFrames--;
+                continue;
+            }
+
+            // This is OK because only legal moves are stored.
+            child = game(nFrames - 1);
+            child.make_move_unchecked(top.moves[top.next++]);
+            length = nFrames;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Returns `true` if no chain of the same length given out before
+     * ended in the given position, remembering it if so.
+     *
+     * @details Single moves never meet, since each empties a different pit.
+     */
+    inline bool is_new(const Game& child, const size length) {
+        if (length == 1)
+            return true;
+
+        // Chains are few, so a linear check is cheaper than hashing.
+        const auto [a, b] = child.get_sides();
+        for (size i = 0; i < nSeen; i++)
+            if (seen[i].length == length && seen[i].a == a.bits() && seen[i].b == b.bits())
+                return false;
+
+        // Past the limit, meeting chains are searched again, which is only slower.
+        if (nSeen < MAX_SEEN)
+            seen[nSeen++] = Seen{ a.bits(), b.bits(), length };
+
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of moves in the current chain.
+     */
+    inline size length() const {
+        return nFrames;
+    }
+
+    /**
+     * @brief Returns the position the current chain's move at the given link
+     * is played from.
+     */
+    inline Game game(const size link) const {
+        return Game(Side::from_bits(frames[link].a), Side::from_bits(frames[link].b));
+    }
+
+    /**
+     * @brief Returns the move of the current chain at the given link.
+     */
+    inline u8 move(const size link) const {
+        return frames[link].moves[frames[link].next - 1];
+    }
+
+    /**
+     * @brief Returns the moves played before the current chain's at the given
+     * link, in the order played.
+     */
+    inline std::span<const u8> tried(const size link) const {
+        return std::span(frames[link].moves.data(), frames[link].next - 1u);
+    }
+
+    /**
+     * @brief Returns the first move of the current chain.
+     */
+    inline u8 first() const {
+        return frames[0].moves[frames[0].next - 1];
+    }
+
+    /**
+     * @brief Returns the last move of the current chain.
+     */
+    inline u8 last() const {
+        const Frame& top = frames[nFrames - 1];
+        return top.moves[top.next - 1];
+    }
+
+    /**
+     * @brief Writes the moves of the current chain, in the order played, to
+     * the start of `out`.
+     *
+     * @warning `out` must hold at least as many moves as the chain.
+     */
+    void moves(std::span<u8> out) const;
+};
@@ -1,23 +1,27 @@
 #include "cli.h"
 
+#include <algorithm>
 #include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <format>
 #include <iostream>
+#include <new>
 #include <optional>
 #include <print>
 #include <sstream>
+#include <string>
+#include <thread>
 
 #include "ai.h"
+#include "bench.h"
+#include "protocol.h"
+#include "server.h"
 #include "def.h"
+#include "parse.h"
 #include "verison.h"
 
-/** 
- * @brief Parses the given string to a `u32`.
- * 
- * @return The parsed integer or `nullopt` if there's an error.
- */
-std::optional<u32> parse_uint(const std::string& s);
-
-CLI::CLI() : game(), isOpen(true) {
+CLI::CLI() : game(), ai(), openingBook(), isOpen(true), isPonderOn(false), ponderGame(), ponderResult() {
     std::println("Rockhop v{}.{}.{}", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
 }
 
@@ -30,6 +34,9 @@ void CLI::process() {
     std::string input;
     std::getline(std::cin, input);
 
+    // The opponent has answered, so its time is over.
+    stop_pondering();
+
     // Match the first token to a command.
     std::istringstream toks(input);
     std::string cmd;
@@ -48,6 +55,38 @@ void CLI::process() {
         go(toks);
     else if (cmd == "e" || cmd == "eval")
         eval(toks);
+    else if (cmd == "ponder")
+        ponder(toks);
+    else if (cmd == "hash")
+        hash(toks);
+    else if (cmd == "threads")
+        threads(toks);
+    else if (cmd == "parallel")
+        parallel(toks);
+    else if (cmd == "driver")
+        driver(toks);
+    else if (cmd == "quiescence")
+        quiescence(toks);
+    else if (cmd == "solver")
+        solver(toks);
+    else if (cmd == "solve")
+        solve(toks);
+    else if (cmd == "tb")
+        tb(toks);
+    else if (cmd == "book")
+        book(toks);
+    else if (cmd == "perft")
+        perft(toks);
+    else if (cmd == "divide")
+        divide(toks);
+    else if (cmd == "bench")
+        bench(toks);
+    else if (cmd == "protocol")
+        protocol(toks);
+    else if (cmd == "server")
+        server(toks);
+    else if (cmd == "analyse")
+        analyse(toks);
     else
         std::println("Unknown comand: \"{}\"", cmd);
     
@@ -72,23 +111,182 @@ void CLI::help(std::istringstream& toks) {
                 tok
             );
         else if (tok == "d" || tok == "display")
-            std::println("{}: Displays the current game state.", tok);
+            std::println("{}: Displays the current game state and its notation.", tok);
         else if (tok == "p" || tok == "pos" || tok == "position")
-            std::println("{}: Sets the position. Example: \"p startpos\".", tok);
+            std::println(
+                "{}: Sets the position to the start or to the given notation."
+                " Example: \"p startpos\", \"p 0,5,5,5,5,4,0/4,4,4,4,4,4,0 b\"."
+                "\n  The notation is the lower side's pits 1 to 6 and mancala, then the upper side's,"
+                " then the side to move (\"a\" for the lower side, \"b\" for the upper). It must hold all {} stones.",
+                tok, N_STONES
+            );
         else if (tok == "go")
             std::println(
                 "{}: Find the best move and make it the given number of times. Example: \"go depth 22 for 4\""
                 "\n  If you want it to play until it's not its turn, use \"persist\"."
-                "\n  If depth is not specified, defaults to {}."
+                "\n  Limit each search by time or nodes with \"movetime <ms>\" or \"nodes <n>\"."
+                "\n  If depth is not specified, defaults to {} (or no cap if time or nodes are limited)."
                 "\n  If number of moves to play is not specified, defaults to 1.",
                 tok, CLI::DEFAULT_DEPTH
             );
         else if (tok == "e" || tok == "eval")
             std::println(
                 "{}: Get the best move and current evaluation with the given depth. Example: \"eval depth 12\"."
-                "\n  If depth is not specified, defaults to {}.",
+                "\n  Limit the search by time or nodes with \"movetime <ms>\" or \"nodes <n>\"."
+                "\n  If depth is not specified, defaults to {} (or no cap if time or nodes are limited).",
                 tok, CLI::DEFAULT_DEPTH
             );
+        else if (tok == "ponder")
+            std::println(
+                "{}: Sets whether the engine keeps searching on the opponent's time after \"go\". Example: \"ponder on\"."
+                "\n  It searches the position after the expected reply, or every reply if it can't tell, until the next command."
+                "\n  If a move then reaches the pondered position, \"go\" to a depth pondering reached plays at once."
+                "\n  With no argument, prints the current setting.",
+                tok
+            );
+        else if (tok == "hash")
+            std::println(
+                "{}: Sets the transposition table size in megabytes or clears it. Example: \"hash 64\", \"hash clear\"."
+                "\n  Resizing also clears the table. With no argument, prints the current size.",
+                tok
+            );
+        else if (tok == "threads")
+            std::println(
+                "{}: Sets the number of threads to search with. Example: \"threads 8\"."
+                "\n  With no argument, prints the current number of threads.",
+                tok
+            );
+        else if (tok == "parallel")
+            std::println(
+                "{}: Sets how multiple threads share a search. Example: \"parallel ybwc\"."
+                "\n  \"lazysmp\": Every thread searches the whole tree, sharing the hash table (default)."
+                "\n  \"ybwc\": Threads split the tree; results at a fixed depth are deterministic."
+                "\n  With no argument, prints the current mode.",
+                tok
+            );
+        else if (tok == "driver")
+            std::println(
+                "{}: Sets how each iteration searches the root. Example: \"driver mtdf\"."
+                "\n  \"full\": One search with a window of every possible score."
+                "\n  \"aspiration\": A narrow window around the last iteration's score, widened on a miss (default)."
+                "\n  \"mtdf\": Null-window searches only, converging on the score (MTD(f))."
+                "\n  With no argument, prints the current driver.",
+                tok
+            );
+        else if (tok == "quiescence")
+            std::println(
+                "{}: Sets whether searches play out captures and chains past the nominal depth."
+                " Example: \"quiescence off\"."
+                "\n  \"on\": Only evaluate positions with no capture or chain to play (default)."
+                "\n  \"off\": Evaluate at the nominal depth."
+                "\n  With no argument, prints the current setting.",
+                tok
+            );
+        else if (tok == "solver")
+            std::println(
+                "{}: Sets the number of stones in the pits at or below which positions are solved to the end of"
+                " the game instead of searched, giving an exact result. Example: \"solver 12\", \"solver off\"."
+                "\n  Up to {} stones (default {}). With no argument, prints the current setting.",
+                tok, Solver::MAX_STONES, Solver::DEFAULT_STONES
+            );
+        else if (tok == "solve")
+            std::println(
+                "{}: Proves the current position won, drawn, or lost for the side to move by proof-number search."
+                " Example: \"solve\", \"solve hash 256 movetime 60000\"."
+                "\n  \"hash <mb>\": The size of the proof table in megabytes (default {})."
+                "\n  Limit the proof by time or nodes with \"movetime <ms>\" or \"nodes <n>\"; by default it runs until done.",
+                tok, Prover::DEFAULT_MB
+            );
+        else if (tok == "tb")
+            std::println(
+                "{}: Manages the endgame tablebase. Example: \"tb gen rockhop.tb 12\", \"tb load rockhop.tb\"."
+                "\n  \"gen <file> <stones>\": Solves every position with up to the given stones in the pits (at most {})."
+                "\n  \"load <file>\": Memory-maps the file so searches use its exact results."
+                "\n  \"unload\": Stops using the tablebase."
+                "\n  With no argument, prints the loaded tablebase's size.",
+                tok, Tablebase::MAX_STONES
+            );
+        else if (tok == "book")
+            std::println(
+                "{}: Manages the opening book. Example: \"book gen rockhop.book 4\", \"book load rockhop.book\"."
+                "\n  \"gen <file> <plies> [depth <n>]\": Searches every position up to the given plies from the start"
+                " (default {} plies, depth {})."
+                "\n  \"load <file>\": Memory-maps the file so \"go\" and \"eval\" play its moves without searching."
+                "\n  \"unload\": Stops using the book."
+                "\n  With no argument, prints the loaded book's size.",
+                tok, Book::DEFAULT_PLIES, Book::DEFAULT_DEPTH
+            );
+        else if (tok == "perft" || tok == "divide")
+            std::println(
+                "{}: Counts the positions the given number of plies from the current one, every move being a ply."
+                " Example: \"{} 8\", \"{} 12 threads 4 hash 64\"."
+                "\n  \"threads <n>\": Counts with the given number of threads (default: the search's)."
+                "\n  \"hash <mb>\": Caches subtree counts in a table of the given size (default: none)."
+                "{}",
+                tok, tok, tok,
+                tok == "divide"
+                    ? "\n  Prints the count below each legal move."
+                    : "\n  \"perft verify [depth <n>]\": Checks the counts from the start position against the reference counts."
+            );
+        else if (tok == "bench")
+            std::println(
+                "{}: Runs a benchmark over a fixed set of positions. Example: \"bench\", \"bench smp depth 16\"."
+                "\n  \"search\": Nodes, time, and NPS searching on one thread; the total nodes are a signature"
+                " of the search's behavior (default, depth {})."
+                "\n  \"endgame\": Like \"search\", over positions with few stones left in the pits (default depth {})."
+                "\n  \"smp\": Time to depth with 1, 2, 4, 8, and 16 threads in each parallel mode (default depth {})."
+                "\n  \"drivers\": Time to depth on one thread with each root search driver (default depth {})."
+                "\n  \"qs [depth <n>] [movetime <ms>] [nodes <n>] [plain <depth>]\": Self-play from every opening of"
+                " {} plies, with quiescence against without, both sides under the given limits (default {} ms per move)."
+                " \"plain\" gives the side without quiescence its own depth."
+                "\n  \"tb\": Time to depth and tablebase hit rates with and without the loaded tablebase (default depth {})."
+                "\n  \"sow\": Time per move sowing with the lookup tables against computed masks, over every move {} plies"
+                " from the start. \"sow verify\" checks both give the same boards, exhaustively over the pits a move's"
+                " result depends on and over every move up to {} plies from the start."
+                "\n  \"position\": Time to walk every line from the start with the side-to-move-first position type"
+                " against the game type, counting leaves and summing their evaluations (default depth {})."
+                "\n  \"stop\": Time from stopping a search with no limits to its result, over the main and endgame positions."
+                "\n  \"server [games <n>] [requests <n>] [workers <n>] [movetime <ms>] [deadline <ms>]\": Plays games against"
+                " a server over a socket pair and reports requests per second and latency percentiles"
+                " (default {} games, {} requests, {} workers, {} ms per search).",
+                tok, Bench::SEARCH_DEPTH, Bench::ENDGAME_DEPTH, Bench::SMP_DEPTH, Bench::DRIVERS_DEPTH, Bench::QS_PLIES, Bench::QS_MOVETIME, Bench::TB_DEPTH,
+                Bench::SOW_PLIES, Bench::SOW_VERIFY_PLIES, Bench::POSITION_DEPTH, Bench::SERVER_LOAD.nGames,
+                Bench::SERVER_LOAD.nRequests, Bench::SERVER_LOAD.nWorkers, Bench::SERVER_LOAD.movetime
+            );
+        else if (tok == "server")
+            std::println(
+                "{}: Hosts many games at once until the end of input, then ends the program."
+                " Example: \"server socket /tmp/rockhop.sock workers 8 hash 512\"."
+                "\n  Reads requests from stdin, or from clients of a Unix socket until one sends \"shutdown\"."
+                "\n  Requests are \"<game id> <command>\", answered as \"<game id> <answer>\" in order for each game:"
+                "\n  \"new\", \"move <moves>\", and \"free\" answer \"ok\"; \"go [depth <n>] [movetime <ms>] [nodes <n>]"
+                " [deadline <ms>]\" answers \"bestmove <move> score <score> depth <depth> nodes <n> time <ms>\"."
+                "\n  Searches run on {} workers by default, taking turns between games, and share a {} MB table."
+                " Without limits a search gets {} ms; a deadline counts from when the request was read.",
+                tok, Server::DEFAULT_WORKERS, Server::DEFAULT_MB, Server::DEFAULT_MOVETIME
+            );
+        else if (tok == "analyse")
+            std::println(
+                "{}: Searches every position in a file and writes the results to another in input order."
+                " Example: \"analyse positions.txt results.txt depth 10 threads 8\"."
+                "\n  Text input has one position per line in \"position\" notation, answered by \"<move> <score> <depth>\""
+                " lines, or \"invalid\"; scores are from the side to move's perspective."
+                "\n  \"binary\": The input is 16-byte records of the lower and upper sides' bits, and the output 8-byte records"
+                " of the score, move, depth, and a flag set for invalid positions."
+                "\n  Repeated positions are searched once. Limit each search with \"depth <n>\", \"movetime <ms>\", or \"nodes <n>\""
+                " (default depth {}); \"threads <n>\" (default: every core) searches that many positions at once, each"
+                " thread with a table of \"hash <mb>\" (default {})."
+                "\n  \"analyse convert <in> <out>\": Writes a text input as a binary one.",
+                tok, CLI::DEFAULT_DEPTH, Analysis::DEFAULT_MB
+            );
+        else if (tok == "protocol")
+            std::println(
+                "{}: Switches to the machine protocol until \"quit\", which also ends the program."
+                "\n  Commands are read while searching: \"isready\" (answers \"readyok\"), \"position startpos [moves ...]\","
+                "\n  \"go [depth <n>] [movetime <ms>] [nodes <n>] [infinite]\" (no limits searches until stopped),"
+                "\n  \"stop\", and \"quit\". Searches print \"info\" lines and end with \"bestmove <move>\".",
+                tok
+            );
         else
             std::println("Unknown command \"{}\", ignoring.", tok);
     }
@@ -125,39 +323,49 @@ void CLI::move(std::istringstream& toks) {
 
     // If here, all moves worked and the game state can be updated.
     game = result;
+
+    // Pondering's result is only any use if it searched this position.
+    if (ponderResult && is_same_game(game, ponderGame) && ponderResult->isExact)
+        std::println("Ponder hit: already solved.");
+    else if (ponderResult && is_same_game(game, ponderGame))
+        std::println("Ponder hit: already searched to depth {}.", ponderResult->depth);
+    else
+        ponderResult.reset();
 }
 
 void CLI::display(std::istringstream&) {
     game.display();
+    std::println("Notation: {}", game.to_notation());
 }
 
 void CLI::position(std::istringstream& toks) {
-    std::string tok;
-    toks >> tok;
-    if (tok == "startpos")
+    std::string rest;
+    std::getline(toks >> std::ws, rest);
+    if (rest == "startpos") {
         game = Game();
-    else
-        std::println("Unknown position argument: \"{}\". Game state unchanged.", tok);
+        return;
+    }
+
+    const auto parsed = Game::from_notation(rest);
+    if (!parsed) {
+        std::println("Unknown position argument: \"{}\". Game state unchanged.", rest);
+        return;
+    }
+    game = parsed.value();
 }
 
 void CLI::go(std::istringstream& toks) {
-    // Get the depth options.
+    // Get the search options.
     const bool  startTurn   = game.is_pov_turn();
-    u32         depth       = CLI::DEFAULT_DEPTH;
+    AI::Limits  limits      = {};
     u32         nMoves      = 1;
     bool        persist     = false;
     std::string tok;
     while (toks >> tok) {
-        if (tok == "depth") {
-            // Get and set depth.
-            toks >> tok;
-            auto n = parse_uint(tok);
-            if (n)
-                depth = n.value();
-            else {
-                std::println("Expected unsigned integer for depth, found \"{}\".", tok);
+        if (is_limit(tok)) {
+            // Get and set the search limit.
+            if (!parse_limit(tok, toks, limits))
                 return;
-            }
         } else if (tok == "for") {
             // Get and set number of moves to play.
             toks >> tok;
@@ -175,6 +383,10 @@ void CLI::go(std::istringstream& toks) {
             return;
         }
     }
+    fill_limits(limits);
+
+    // The line expected from the last move played, starting with that move.
+    Search::Line pv = {};
 
     u32 i = 0;
     while (i++ < nMoves || (persist && game.is_pov_turn() == startTurn)) {
@@ -184,30 +396,711 @@ void CLI::go(std::istringstream& toks) {
             break;
         }
 
+        // Play from the book if it has the position.
+        if (const auto entry = openingBook.probe(game)) {
+            std::println("Playing book move {} (searched to depth {}).", entry->move, entry->depth);
+            game.make_move(entry->move);
+            pv = {};
+            continue;
+        }
+
+        // Play pondering's move if it solved this position, or searched it deep
+        // enough under a fixed depth; budgeted searches still gain from its table.
+        const bool isPonderHit = ponderResult
+            && is_same_game(game, ponderGame)
+            && (ponderResult->isExact || (limits.movetime == 0 && limits.nodes == 0 && ponderResult->depth >= limits.depth));
+        if (isPonderHit) {
+            if (ponderResult->isExact)
+                std::println("Playing pondered move {} (solved).", ponderResult->move);
+            else
+                std::println("Playing pondered move {} (searched to depth {}).", ponderResult->move, ponderResult->depth);
+            game.make_move(ponderResult->move);
+            pv = ponderResult->pv;
+            ponderResult.reset();
+            continue;
+        }
+        ponderResult.reset();
+
         // Get the best move.
-        std::println("Thinking with depth {}...", depth);
-        auto [move, _] = AI::find_move(game, depth);
+        std::println("Thinking with {}...", describe_limits(limits));
+        const auto result = ai.find_move(game, limits, print_info);
+        std::println("Searched to depth {} in {} ms ({} nodes).", result.depth, result.time, result.nodes);
 
         // Say and make it.
-        std::println("Playing move {}.", move);
-        game.make_move(move);
+        std::println("Playing move {}.", result.move);
+        game.make_move(result.move);
+        pv = result.pv;
     }
+
+    if (isPonderOn && !game.is_over())
+        start_pondering(pv, startTurn);
 }
 
 void CLI::eval(std::istringstream& toks) {
-    u32 depth = CLI::DEFAULT_DEPTH;
+    AI::Limits limits = {};
+
+    // See if any limits were given.
+    std::string tok;
+    while (toks >> tok) {
+        if (is_limit(tok)) {
+            // Get and set the search limit.
+            if (!parse_limit(tok, toks, limits))
+                return;
+        } else {
+            std::println("Unknown argument \"{}\"", tok);
+            return;
+        }
+    }
+    fill_limits(limits);
+
+    // Use the book's evaluation if it has the position.
+    const auto start = std::chrono::steady_clock::now();
+    if (const auto entry = openingBook.probe(game)) {
+        const auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        std::println("Found in the opening book.");
+        std::println("Best move:   {}", entry->move);
+        std::println("Evaluation:  {}", entry->score);
+        std::println("Depth:       {}", entry->depth);
+        std::println("Time:        {} us", time);
+        return;
+    }
+
+    // Get evaluation.
+    std::println("Evaluating with {}...", describe_limits(limits));
+    const auto result = ai.find_move(game, limits, print_info);
+    std::println("Best move:   {}", result.move);
+    std::println("Evaluation:  {}", result.score);
+    if (result.isExact)
+        std::println("Exact:       {:+} stones", result.stoneDiff);
+    std::println("PV:          {}", format_line(result.pv));
+    std::println("Depth:       {}", result.depth);
+    std::println("Nodes:       {}", result.nodes);
+    std::println("Time:        {} ms", result.time);
+    if (result.tbProbes > 0)
+        std::println("TB hits:     {} of {} probes", result.tbHits, result.tbProbes);
+}
+
+void CLI::ponder(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current setting.
+    } else if (tok == "on")
+        isPonderOn = true;
+    else if (tok == "off")
+        isPonderOn = false;
+    else {
+        std::println("Expected \"on\" or \"off\" for ponder, found \"{}\".", tok);
+        return;
+    }
+
+    std::println("Ponder: {}", isPonderOn ? "on" : "off");
+}
+
+void CLI::hash(std::istringstream& toks) {
+    TTable&     table   = ai.get_table();
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current size.
+        std::println("Hash size: {} MB", table.size_mb());
+    } else if (tok == "clear") {
+        table.clear();
+        std::println("Hash cleared.");
+    } else {
+        // Get and set the size.
+        auto n = parse_uint(tok);
+        if (n && n.value() > 0) {
+            try {
+                table.resize(n.value());
+                std::println("Hash size: {} MB", table.size_mb());
+            } catch (const std::bad_alloc&) {
+                std::println("Could not allocate {} MB; hash size stays {} MB.", n.value(), table.size_mb());
+            }
+        } else
+            std::println("Expected \"clear\" or a positive integer for hash size, found \"{}\".", tok);
+    }
+}
+
+void CLI::threads(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current number of threads.
+        std::println("Threads: {}", ai.get_threads());
+    } else {
+        // Get and set the number of threads.
+        auto n = parse_uint(tok);
+        if (n && n.value() > 0) {
+            ai.set_threads(n.value());
+            std::println("Threads: {}", ai.get_threads());
+        } else
+            std::println("Expected a positive integer for threads, found \"{}\".", tok);
+    }
+}
+
+void CLI::parallel(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current mode.
+    } else if (tok == AI::mode_name(AI::Mode::LAZY_SMP))
+        ai.set_mode(AI::Mode::LAZY_SMP);
+    else if (tok == AI::mode_name(AI::Mode::YBWC))
+        ai.set_mode(AI::Mode::YBWC);
+    else {
+        std::println("Unknown parallel mode \"{}\".", tok);
+        return;
+    }
+
+    std::println("Parallel mode: {}", AI::mode_name(ai.get_mode()));
+}
+
+void CLI::driver(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current driver.
+    } else if (tok == AI::driver_name(AI::Driver::FULL_WINDOW))
+        ai.set_driver(AI::Driver::FULL_WINDOW);
+    else if (tok == AI::driver_name(AI::Driver::ASPIRATION))
+        ai.set_driver(AI::Driver::ASPIRATION);
+    else if (tok == AI::driver_name(AI::Driver::MTDF))
+        ai.set_driver(AI::Driver::MTDF);
+    else {
+        std::println("Unknown driver \"{}\".", tok);
+        return;
+    }
+
+    std::println("Driver: {}", AI::driver_name(ai.get_driver()));
+}
+
+void CLI::quiescence(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current setting.
+    } else if (tok == "on")
+        ai.set_quiescence(true);
+    else if (tok == "off")
+        ai.set_quiescence(false);
+    else {
+        std::println("Expected \"on\" or \"off\" for quiescence, found \"{}\".", tok);
+        return;
+    }
+
+    std::println("Quiescence: {}", ai.get_quiescence() ? "on" : "off");
+}
+
+void CLI::solver(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show the current setting.
+    } else if (tok == "off")
+        ai.set_solver_stones(0);
+    else if (const auto n = parse_uint(tok))
+        ai.set_solver_stones(n.value());
+    else {
+        std::println("Expected a number of stones or \"off\" for the solver, found \"{}\".", tok);
+        return;
+    }
+
+    if (ai.get_solver_stones() > 0)
+        std::println("Solver: up to {} stones", ai.get_solver_stones());
+    else
+        std::println("Solver: off");
+}
+
+void CLI::solve(std::istringstream& toks) {
+    Prover::Options options = { Prover::DEFAULT_MB, 0, 0 };
+
+    // See if any options were given.
+    std::string tok;
+    while (toks >> tok) {
+        if (tok == "hash" || tok == "movetime" || tok == "nodes") {
+            std::string val;
+            toks >> val;
+            const auto n = parse_ulong(val);
+            if (!n || (tok == "hash" && n.value() == 0)) {
+                std::println("Expected a positive integer for {}, found \"{}\".", tok, val);
+                return;
+            }
+
+            if (tok == "hash")
+                options.hashMb = n.value();
+            else if (tok == "movetime")
+                options.movetime = n.value();
+            else
+                options.nodes = n.value();
+        } else {
+            std::println("Unknown argument \"{}\"", tok);
+            return;
+        }
+    }
+
+    Tablebase&  tablebase   = ai.get_tablebase();
+    Prover      prover(options.hashMb);
+    std::println("Proving with a {} MB table...", options.hashMb);
+    const auto result = prover.prove(game, options, tablebase.is_loaded() ? &tablebase : nullptr, print_progress);
+
+    if (result.outcome == Prover::Outcome::UNKNOWN)
+        std::println("Result:      unknown, a limit was reached");
+    else if (result.outcome == Prover::Outcome::DRAW)
+        std::println("Result:      draw");
+    else
+        std::println("Result:      {} for the side to move", Prover::outcome_name(result.outcome));
+    if (result.move != 0)
+        std::println("Move:        {}", result.move);
+    std::println("Nodes:       {}", result.nodes);
+    std::println("Time:        {} ms", result.time);
+    std::println("NPS:         {}", result.nodes * 1000 / std::max<u64>(result.time, 1));
+}
+
+void CLI::tb(std::istringstream& toks) {
+    Tablebase&  tablebase   = ai.get_tablebase();
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show what's loaded.
+        if (tablebase.is_loaded())
+            std::println("Tablebase loaded for up to {} stones.", tablebase.max_stones());
+        else
+            std::println("No tablebase loaded.");
+    } else if (tok == "gen") {
+        // Get the file and stone count.
+        std::string path;
+        toks >> path >> tok;
+        auto n = parse_uint(tok);
+        if (path.empty() || !n || n.value() > Tablebase::MAX_STONES) {
+            std::println("Expected a file and at most {} stones, found \"{}\".", Tablebase::MAX_STONES, tok);
+            return;
+        }
+
+        std::println("Generating tablebase for up to {} stones...", n.value());
+        if (Tablebase::generate(path, n.value(), std::max(1U, std::thread::hardware_concurrency())))
+            std::println("Wrote \"{}\".", path);
+        else
+            std::println("Could not write \"{}\".", path);
+    } else if (tok == "load") {
+        std::string path;
+        toks >> path;
+        if (tablebase.load(path))
+            std::println("Tablebase loaded for up to {} stones.", tablebase.max_stones());
+        else
+            std::println("Could not load a tablebase from \"{}\".", path);
+    } else if (tok == "unload") {
+        tablebase.unload();
+        std::println("Tablebase unloaded.");
+    } else
+        std::println("Unknown tb argument \"{}\".", tok);
+}
+
+void CLI::book(std::istringstream& toks) {
+    std::string tok;
+
+    if (!(toks >> tok)) {
+        // No argument; show what's loaded.
+        if (openingBook.is_loaded())
+            std::println(
+                "Book loaded with {} positions up to {} plies.",
+                openingBook.n_entries(), openingBook.n_plies()
+            );
+        else
+            std::println("No book loaded.");
+    } else if (tok == "gen") {
+        // Get the file and ply count.
+        std::string path;
+        u32         plies   = Book::DEFAULT_PLIES;
+        u32         depth   = Book::DEFAULT_DEPTH;
+        toks >> path;
+        if (path.empty()) {
+            std::println("Expected a file to write the book to.");
+            return;
+        }
+        if (toks >> tok) {
+            auto n = parse_uint(tok);
+            if (!n) {
+                std::println("Expected unsigned integer for plies, found \"{}\".", tok);
+                return;
+            }
+            plies = n.value();
+        }
+
+        // See if a depth was given.
+        if (toks >> tok) {
+            if (tok == "depth") {
+                toks >> tok;
+                auto n = parse_uint(tok);
+                if (n && n.value() > 0 && n.value() <= static_cast<u32>(AI::MAX_DEPTH))
+                    depth = n.value();
+                else {
+                    std::println("Expected depth from 1 to {}, found \"{}\".", AI::MAX_DEPTH, tok);
+                    return;
+                }
+            } else {
+                std::println("Unknown argument \"{}\"", tok);
+                return;
+            }
+        }
+
+        std::println("Generating book for {} plies at depth {}...", plies, depth);
+        const auto nThreads = std::max(1U, std::thread::hardware_concurrency());
+        if (Book::generate(path, plies, static_cast<i32>(depth), nThreads))
+            std::println("Wrote \"{}\".", path);
+        else
+            std::println("Could not write \"{}\".", path);
+    } else if (tok == "load") {
+        std::string path;
+        toks >> path;
+        if (openingBook.load(path))
+            std::println(
+                "Book loaded with {} positions up to {} plies.",
+                openingBook.n_entries(), openingBook.n_plies()
+            );
+        else
+            std::println("Could not load a book from \"{}\".", path);
+    } else if (tok == "unload") {
+        openingBook.unload();
+        std::println("Book unloaded.");
+    } else
+        std::println("Unknown book argument \"{}\".", tok);
+}
+
+void CLI::perft(std::istringstream& toks) {
+    std::string tok;
+    toks >> tok;
+    if (tok == "verify") {
+        verify_perft(toks);
+        return;
+    }
+
+    i32             depth   = 0;
+    Perft::Options  options = {};
+    if (!parse_perft(tok, toks, depth, options))
+        return;
+
+    const auto  start   = std::chrono::steady_clock::now();
+    const u64   nodes   = Perft::count(game, depth, options);
+    const f64   time    = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::println("Nodes:       {}", nodes);
+    std::println("Time:        {:.0f} ms", time);
+    std::println("NPS:         {:.0f}", nodes / std::max(time / 1000.0, 1e-6));
+}
 
+void CLI::verify_perft(std::istringstream& toks) {
     // See if a depth was given.
+    i32         maxDepth    = static_cast<i32>(Perft::REFERENCE.size()) - 1;
     std::string tok;
     if (toks >> tok) {
         if (tok == "depth") {
-            // Get and set depth.
             toks >> tok;
             auto n = parse_uint(tok);
-            if (n)
+            if (n && n.value() < Perft::REFERENCE.size())
+                maxDepth = static_cast<i32>(n.value());
+            else {
+                std::println("Expected depth up to {}, found \"{}\".", Perft::REFERENCE.size() - 1, tok);
+                return;
+            }
+        } else {
+            std::println("Unknown argument \"{}\"", tok);
+            return;
+        }
+    }
+
+    // Count from the start position and compare.
+    const Perft::Options    options = { ai.get_threads(), 0 };
+    bool                    isOk    = true;
+    for (i32 depth = 0; depth <= maxDepth; depth++) {
+        const u64 nodes = Perft::count(Game(), depth, options);
+        isOk &= nodes == Perft::REFERENCE[depth];
+        std::println("Depth {:>2}: {:>12} {}", depth, nodes, nodes == Perft::REFERENCE[depth] ? "ok" : "MISMATCH");
+    }
+
+    if (isOk)
+        std::println("All counts match the reference.");
+    else
+        std::println("Counts differ from the reference.");
+}
+
+void CLI::divide(std::istringstream& toks) {
+    std::string     tok;
+    i32             depth   = 0;
+    Perft::Options  options = {};
+    toks >> tok;
+    if (!parse_perft(tok, toks, depth, options))
+        return;
+
+    const auto  start   = std::chrono::steady_clock::now();
+    const auto  counts  = Perft::divide(game, depth, options);
+    const f64   time    = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    u64         nodes   = 0;
+    for (const auto& [move, n]: counts) {
+        std::println("{}: {}", move, n);
+        nodes += n;
+    }
+    std::println("Nodes:       {}", nodes);
+    std::println("Time:        {:.0f} ms", time);
+    std::println("NPS:         {:.0f}", nodes / std::max(time / 1000.0, 1e-6));
+}
+
+void CLI::protocol(std::istringstream&) {
+    std::println("Rockhop v{}.{}.{} protocol", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+    std::fflush(stdout);
+    Protocol(ai, game).run();
+    isOpen = false;
+}
+
+void CLI::server(std::istringstream& toks) {
+    std::string path;
+    size        nWorkers    = Server::DEFAULT_WORKERS;
+    size        mb          = Server::DEFAULT_MB;
+    std::string tok;
+    while (toks >> tok) {
+        std::string val;
+        toks >> val;
+        if (tok == "socket") {
+            path = val;
+            continue;
+        }
+
+        const auto n = parse_ulong(val);
+        if (!n || n.value() == 0) {
+            std::println("Expected a positive integer for {}, found \"{}\".", tok, val);
+            return;
+        }
+
+        if (tok == "workers")
+            nWorkers = n.value();
+        else if (tok == "hash")
+            mb = n.value();
+        else {
+            std::println("Unknown server argument \"{}\"", tok);
+            return;
+        }
+    }
+
+    std::println(
+        "Serving on {} with {} workers and a {} MB table.",
+        path.empty() ? "stdin" : path, std::clamp<size>(nWorkers, 1, AI::MAX_THREADS), mb
+    );
+    std::fflush(stdout);
+
+    Server server(nWorkers, mb);
+    if (path.empty())
+        server.serve_stdin();
+    else if (!server.listen(path))
+        std::println("Failed to listen on \"{}\".", path);
+    isOpen = false;
+}
+
+void CLI::analyse(std::istringstream& toks) {
+    std::string inPath;
+    std::string outPath;
+    std::string tok;
+    toks >> tok;
+    if (tok == "convert") {
+        toks >> inPath >> outPath;
+        if (outPath.empty()) {
+            std::println("Expected a text file to read and a binary file to write.");
+            return;
+        }
+
+        if (const auto nRecords = Analysis::convert(inPath, outPath))
+            std::println("Wrote {} records to \"{}\".", nRecords.value(), outPath);
+        else
+            std::println("Could not convert \"{}\" to \"{}\".", inPath, outPath);
+        return;
+    }
+
+    inPath = tok;
+    toks >> outPath;
+    if (outPath.empty()) {
+        std::println("Expected a file to read positions from and a file to write results to.");
+        return;
+    }
+
+    // Get the options.
+    Analysis::Format    format  = Analysis::Format::TEXT;
+    Analysis::Options   options = { {}, std::max(1U, std::thread::hardware_concurrency()), Analysis::DEFAULT_MB };
+    while (toks >> tok) {
+        if (tok == "binary") {
+            format = Analysis::Format::BINARY;
+            continue;
+        }
+        if (is_limit(tok)) {
+            if (!parse_limit(tok, toks, options.limits))
+                return;
+            continue;
+        }
+
+        std::string val;
+        toks >> val;
+        const auto n = parse_ulong(val);
+        if (!n || n.value() == 0) {
+            std::println("Expected a positive integer for {}, found \"{}\".", tok, val);
+            return;
+        }
+
+        if (tok == "threads")
+            options.nThreads = n.value();
+        else if (tok == "hash")
+            options.hashMb = n.value();
+        else {
+            std::println("Unknown analyse argument \"{}\"", tok);
+            return;
+        }
+    }
+    fill_limits(options.limits);
+
+    std::println(
+        "Analysing {} positions from \"{}\" with {} threads, {}.",
+        Analysis::format_name(format), inPath, options.nThreads, describe_limits(options.limits)
+    );
+    std::fflush(stdout);
+
+    const auto result = Analysis::run(inPath, outPath, format, options, [](const Analysis::Progress& progress){
+        std::println(
+            "info positions {} unique {} done {} nodes {} time {}",
+            progress.nPositions, progress.nUnique, progress.nDone, progress.nodes, progress.time
+        );
+        std::fflush(stdout);
+    });
+    if (!result) {
+        std::println("Could not analyse \"{}\" into \"{}\".", inPath, outPath);
+        return;
+    }
+
+    std::println("Positions:   {}", result->nPositions);
+    std::println("Unique:      {}", result->nUnique);
+    std::println("Invalid:     {}", result->nInvalid);
+    std::println("Nodes:       {}", result->nodes);
+    std::println("Time:        {} ms", result->time);
+    std::println("Positions/s: {:.0f}", result->nPositions * 1000.0 / std::max<u64>(result->time, 1));
+    std::println("Wrote \"{}\".", outPath);
+}
+
+void CLI::bench(std::istringstream& toks) {
+    // Get the benchmark, defaulting to the search benchmark.
+    std::string name    = "search";
+    std::string tok;
+    if (toks >> tok && tok != "depth") {
+        name = tok;
+        toks >> tok;
+    }
+
+    if (name != "search" && name != "endgame" && name != "smp" && name != "drivers" && name != "qs" && name != "tb" && name != "sow" && name != "position" && name != "stop" && name != "server") {
+        std::println("Unknown benchmark \"{}\".", name);
+        return;
+    }
+
+    // The sowing benchmark only compares move kernels.
+    if (name == "sow") {
+        if (!toks)
+            Bench::sowing();
+        else if (tok == "verify")
+            Bench::verify_sowing();
+        else
+            std::println("Unknown argument \"{}\"", tok);
+        return;
+    }
+
+    // Stopping takes no depth; the searches run until stopped.
+    if (name == "stop") {
+        Bench::stop_latency();
+        return;
+    }
+
+    // The load generator takes its own options instead of a depth.
+    if (name == "server") {
+        Bench::ServerLoad load = Bench::SERVER_LOAD;
+        for (bool isTok = static_cast<bool>(toks); isTok; isTok = static_cast<bool>(toks >> tok)) {
+            std::string val;
+            toks >> val;
+            const auto n = parse_ulong(val);
+            if (!n || (n.value() == 0 && tok != "deadline")) {
+                std::println("Expected a positive integer for {}, found \"{}\".", tok, val);
+                return;
+            }
+
+            if (tok == "games")
+                load.nGames = n.value();
+            else if (tok == "requests")
+                load.nRequests = n.value();
+            else if (tok == "workers")
+                load.nWorkers = n.value();
+            else if (tok == "movetime")
+                load.movetime = n.value();
+            else if (tok == "deadline")
+                load.deadline = n.value();
+            else {
+                std::println("Unknown argument \"{}\"", tok);
+                return;
+            }
+        }
+
+        Bench::server(load);
+        return;
+    }
+
+    // Self-play takes search limits for both sides instead of a depth.
+    if (name == "qs") {
+        AI::Limits  limits      = {};
+        i32         plainDepth  = 0;
+        for (bool isTok = static_cast<bool>(toks); isTok; isTok = static_cast<bool>(toks >> tok)) {
+            if (is_limit(tok)) {
+                if (!parse_limit(tok, toks, limits))
+                    return;
+            } else if (tok == "plain") {
+                toks >> tok;
+                auto n = parse_uint(tok);
+                if (!n || n.value() == 0) {
+                    std::println("Expected positive integer for the plain search's depth, found \"{}\".", tok);
+                    return;
+                }
+                plainDepth = static_cast<i32>(std::min<u32>(n.value(), AI::MAX_DEPTH));
+            } else {
+                std::println("Unknown argument \"{}\"", tok);
+                return;
+            }
+        }
+
+        // Default to a fixed time per move, with no depth cap if none was given.
+        if (limits.depth == 0 && limits.movetime == 0 && limits.nodes == 0)
+            limits.movetime = Bench::QS_MOVETIME;
+        if (limits.depth == 0)
+            limits.depth = AI::MAX_DEPTH;
+
+        AI::Limits plainLimits = limits;
+        if (plainDepth > 0)
+            plainLimits.depth = plainDepth;
+
+        Bench::quiescence(limits, plainLimits);
+        return;
+    }
+
+    // See if a depth was given.
+    u32 depth = name == "search"
+        ? Bench::SEARCH_DEPTH
+        : name == "endgame"
+            ? Bench::ENDGAME_DEPTH
+            : name == "smp"
+                ? Bench::SMP_DEPTH
+                : name == "drivers"
+                    ? Bench::DRIVERS_DEPTH
+                    : name == "position"
+                        ? Bench::POSITION_DEPTH
+                        : Bench::TB_DEPTH;
+    if (toks) {
+        if (tok == "depth") {
+            toks >> tok;
+            auto n = parse_uint(tok);
+            if (n && n.value() > 0)
                 depth = n.value();
             else {
-                std::println("Expected unsigned integer for depth, found \"{}\"", tok);
+                std::println("Expected positive integer for depth, found \"{}\".", tok);
                 return;
             }
         } else {
@@ -216,21 +1109,169 @@ void CLI::eval(std::istringstream& toks) {
         }
     }
 
-    // Get evaluation.
-    std::println("Evaluating with depth {}...", depth);
-    auto [move, eval] = AI::find_move(game, depth);
-    std::println("Best move:   {}", move);
-    std::println("Evaluation:  {}", eval);
+    if (name == "search")
+        Bench::search(static_cast<i32>(depth));
+    else if (name == "endgame")
+        Bench::search(static_cast<i32>(depth), Bench::ENDGAMES);
+    else if (name == "smp")
+        Bench::smp(static_cast<i32>(depth));
+    else if (name == "drivers")
+        Bench::drivers(static_cast<i32>(depth));
+    else if (name == "position")
+        Bench::position(static_cast<i32>(depth));
+    else if (ai.get_tablebase().is_loaded())
+        Bench::tablebase(ai, static_cast<i32>(depth));
+    else
+        std::println("Load a tablebase with \"tb load\" first.");
+}
+
+bool CLI::is_limit(const std::string& tok) {
+    return tok == "depth" || tok == "movetime" || tok == "nodes";
 }
 
-std::optional<u32> parse_uint(const std::string& s) {
-    // Attempt to parse to integer.
-    u32 n = 0;
-    auto [_, e] = std::from_chars(s.data(), s.data() + s.size(), n);
+bool CLI::parse_limit(const std::string& tok, std::istringstream& toks, AI::Limits& limits) {
+    std::string val;
+    toks >> val;
+    auto n = parse_ulong(val);
+    if (!n) {
+        std::println("Expected unsigned integer for {}, found \"{}\".", tok, val);
+        return false;
+    }
 
-    if (e == std::errc{})
-        return n;
+    if (tok == "depth")
+        limits.depth = static_cast<i32>(std::min<u64>(n.value(), AI::MAX_DEPTH));
+    else if (tok == "movetime")
+        limits.movetime = n.value();
     else
-        // Invalid integer.
-        return std::nullopt;
+        limits.nodes = n.value();
+
+    return true;
+}
+
+void CLI::start_pondering(const Search::Line& pv, const bool engineTurn) {
+    // Follow the line through the opponent's whole turn, if it reaches that far.
+    Game            expected    = game;
+    Search::Line    reply       = {};
+    for (size i = 1; i < pv.length && expected.is_pov_turn() != engineTurn && !expected.is_over(); i++) {
+        if (!expected.make_move(pv.moves[i]))
+            break;
+        reply.moves[reply.length++] = pv.moves[i];
+    }
+
+    if (game.is_pov_turn() != engineTurn && expected.is_pov_turn() == engineTurn && !expected.is_over()) {
+        std::println("Pondering the expected reply {}.", format_line(reply));
+        ponderGame = expected;
+    } else {
+        std::println("Pondering every reply.");
+        ponderGame = game;
+    }
+
+    ponderResult.reset();
+    ai.start_search(ponderGame, AI::Limits{ AI::MAX_DEPTH, 0, 0 });
+}
+
+void CLI::stop_pondering() {
+    ai.stop();
+    const auto result = ai.wait();
+    if (result && result->depth > 0)
+        ponderResult = result;
+}
+
+bool CLI::is_same_game(const Game& x, const Game& y) {
+    const auto [xa, xb] = x.get_sides();
+    const auto [ya, yb] = y.get_sides();
+    return xa.bits() == ya.bits() && xb.bits() == yb.bits();
+}
+
+void CLI::fill_limits(AI::Limits& limits) {
+    // Budgeted searches go as deep as they can unless capped.
+    if (limits.depth == 0)
+        limits.depth = (limits.movetime > 0 || limits.nodes > 0)
+            ? AI::MAX_DEPTH
+            : CLI::DEFAULT_DEPTH;
+}
+
+void CLI::print_info(const AI::Result& result) {
+    std::print(
+        "info depth {} score {} move {} nodes {} time {} itertime {} nps {} tbprobes {} tbhits {}",
+        result.depth, result.score, result.move, result.nodes, result.time, result.iterTime,
+        result.nodes * 1000 / std::max<u64>(result.time, 1), result.tbProbes, result.tbHits
+    );
+
+    // A solved position's score is the game's result.
+    if (result.isExact)
+        std::print(" exact {}", result.stoneDiff);
+
+    // Statistics are only counted when built in.
+    if constexpr (Search::STATS) {
+        const auto& stats = result.stats;
+        std::print(
+            " evals {} ttprobes {} tthits {} cutoffs {} firstcutoffs {} cutoffindex {}",
+            stats.evals, stats.ttProbes, stats.ttHits, stats.n_cutoffs(), stats.cutoffs[0],
+            std::format("{},{},{},{},{},{}",
+                stats.cutoffs[0], stats.cutoffs[1], stats.cutoffs[2],
+                stats.cutoffs[3], stats.cutoffs[4], stats.cutoffs[5]
+            )
+        );
+    }
+
+    std::println(" pv {}", format_line(result.pv));
+}
+
+void CLI::print_progress(const Prover::Progress& progress) {
+    std::println(
+        "info goal {} proof {} disproof {} nodes {} time {} nps {} hashfull {}",
+        Prover::goal_name(progress.goal), progress.proof, progress.disproof,
+        progress.nodes, progress.time, progress.nodes * 1000 / std::max<u64>(progress.time, 1), progress.hashfull
+    );
+}
+
+std::string CLI::format_line(const Search::Line& line) {
+    std::string moves;
+    for (size i = 0; i < line.length; i++) {
+        if (i > 0)
+            moves += ' ';
+        moves += std::to_string(line.moves[i]);
+    }
+
+    return moves;
+}
+
+bool CLI::parse_perft(const std::string& depthTok, std::istringstream& toks, i32& depth, Perft::Options& options) {
+    // Get the depth.
+    auto n = parse_uint(depthTok);
+    if (!n) {
+        std::println("Expected unsigned integer for depth, found \"{}\".", depthTok);
+        return false;
+    }
+    depth   = static_cast<i32>(n.value());
+    options = { ai.get_threads(), 0 };
+
+    // Get the options.
+    std::string tok;
+    while (toks >> tok) {
+        const std::string name = tok;
+        toks >> tok;
+        n = parse_uint(tok);
+        if (name == "threads" && n && n.value() > 0)
+            options.nThreads = std::min<size>(n.value(), AI::MAX_THREADS);
+        else if (name == "hash" && n)
+            options.hashMb = n.value();
+        else {
+            std::println("Unknown or invalid argument \"{} {}\".", name, tok);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string CLI::describe_limits(const AI::Limits& limits) {
+    std::string desc = std::format("depth {}", limits.depth);
+    if (limits.movetime > 0)
+        desc += std::format(", movetime {} ms", limits.movetime);
+    if (limits.nodes > 0)
+        desc += std::format(", nodes {}", limits.nodes);
+
+    return desc;
 }
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <optional>
 #include <sstream>
+#include <string>
 
+#include "ai.h"
+#include "analysis.h"
+#include "book.h"
+#include "perft.h"
+#include "prover.h"
 #include "game.h"
 
 class CLI {
@@ -16,11 +23,38 @@ private:
      */
     Game game;
 
+    /**
+     * @brief The engine.
+     */
+    AI ai;
+
+    /**
+     * @brief The opening book, checked before searching.
+     */
+    Book openingBook;
+
     /**
      * @brief Is `true` when the CLI was closed, `false` if not.
      */
     bool isOpen;
 
+    /**
+     * @brief Is `true` if the engine keeps searching on the opponent's time
+     * after "go".
+     */
+    bool isPonderOn;
+
+    /**
+     * @brief The position last pondered.
+     */
+    Game ponderGame;
+
+    /**
+     * @brief The result of the last pondering, until a "go" uses or discards
+     * it or a move leaves `ponderGame` unreachable.
+     */
+    std::optional<AI::Result> ponderResult;
+
 public:
     CLI();
 
@@ -83,4 +117,186 @@ private:
      * Searches for the best move and displays it and the evaluation.
      */
     void eval(std::istringstream& toks);
+
+    /**
+     * @brief Handles "ponder".
+     * 
+     * Sets whether the engine searches on the opponent's time.
+     */
+    void ponder(std::istringstream& toks);
+
+    /**
+     * @brief Handles "hash".
+     * 
+     * Resizes or clears the transposition table.
+     */
+    void hash(std::istringstream& toks);
+
+    /**
+     * @brief Handles "threads".
+     * 
+     * Sets the number of search threads.
+     */
+    void threads(std::istringstream& toks);
+
+    /**
+     * @brief Handles "parallel".
+     * 
+     * Sets how multiple threads share a search.
+     */
+    void parallel(std::istringstream& toks);
+
+    /**
+     * @brief Handles "driver".
+     * 
+     * Sets how each iteration searches the root.
+     */
+    void driver(std::istringstream& toks);
+
+    /**
+     * @brief Handles "quiescence".
+     * 
+     * Sets whether searches extend the horizon by captures and chains.
+     */
+    void quiescence(std::istringstream& toks);
+
+    /**
+     * @brief Handles "solver".
+     * 
+     * Sets the number of stones in the pits below which positions are solved.
+     */
+    void solver(std::istringstream& toks);
+
+    /**
+     * @brief Handles "solve".
+     * 
+     * Proves the current position won, drawn, or lost for the side to move.
+     */
+    void solve(std::istringstream& toks);
+
+    /**
+     * @brief Handles "tb".
+     * 
+     * Generates, loads, or unloads an endgame tablebase.
+     */
+    void tb(std::istringstream& toks);
+
+    /**
+     * @brief Handles "book".
+     * 
+     * Generates, loads, or unloads an opening book.
+     */
+    void book(std::istringstream& toks);
+
+    /**
+     * @brief Handles "perft".
+     * 
+     * Counts the positions a number of plies from the current one.
+     */
+    void perft(std::istringstream& toks);
+
+    /**
+     * @brief Handles "perft verify".
+     * 
+     * Checks the counts from the start position against the reference counts.
+     */
+    void verify_perft(std::istringstream& toks);
+
+    /**
+     * @brief Handles "divide".
+     * 
+     * Counts the positions a number of plies from the current one below each move.
+     */
+    void divide(std::istringstream& toks);
+
+    /**
+     * @brief Handles "bench".
+     * 
+     * Runs the given benchmark.
+     */
+    void bench(std::istringstream& toks);
+
+    /**
+     * @brief Handles "protocol".
+     * 
+     * Hands the input to the machine protocol until it quits, then closes the CLI.
+     */
+    void protocol(std::istringstream& toks);
+
+    /**
+     * @brief Handles "server".
+     * 
+     * Hosts many games on a worker pool until the input ends, then closes the CLI.
+     */
+    void server(std::istringstream& toks);
+
+    /**
+     * @brief Handles "analyse".
+     * 
+     * Searches every position in a file and writes the results to another.
+     */
+    void analyse(std::istringstream& toks);
+
+    /**
+     * @brief Starts pondering after "go" played the first move of `pv` for
+     * the side whose turn is `engineTurn`: the position after the expected
+     * reply if `pv` holds all of it, or the opponent's position, covering
+     * every reply, if not.
+     */
+    void start_pondering(const Search::Line& pv, bool engineTurn);
+
+    /**
+     * @brief Stops pondering, keeping its result if it completed an iteration.
+     */
+    void stop_pondering();
+
+    /**
+     * @brief Returns `true` if the games have the same sides and turn.
+     */
+    static bool is_same_game(const Game& x, const Game& y);
+
+    /**
+     * @brief Returns `true` if the given token names a search limit.
+     */
+    static bool is_limit(const std::string& tok);
+
+    /**
+     * @brief Reads the value of the given search limit from the tokens.
+     * 
+     * @return `false` if the value was invalid, `true` if not.
+     */
+    static bool parse_limit(const std::string& tok, std::istringstream& toks, AI::Limits& limits);
+
+    /**
+     * @brief Sets the depth of limits that did not specify one.
+     */
+    static void fill_limits(AI::Limits& limits);
+
+    /**
+     * @brief Returns a readable description of the search limits.
+     */
+    static std::string describe_limits(const AI::Limits& limits);
+
+    /**
+     * @brief Prints the progress of a search as an "info" line of names and values.
+     */
+    static void print_info(const AI::Result& result);
+
+    /**
+     * @brief Prints the progress of a proof as an "info" line of names and values.
+     */
+    static void print_progress(const Prover::Progress& progress);
+
+    /**
+     * @brief Returns the moves of the line separated by spaces.
+     */
+    static std::string format_line(const Search::Line& line);
+
+    /**
+     * @brief Reads the depth and options of "perft" or "divide" from the given
+     * depth token and the tokens after it.
+     * 
+     * @return `false` if an argument was invalid, `true` if not.
+     */
+    bool parse_perft(const std::string& depthTok, std::istringstream& toks, i32& depth, Perft::Options& options);
 };
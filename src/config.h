@@ -22,6 +22,11 @@ static constexpr inline u64 N_STONES            = N_STARTING_STONES * N_PITS * 2
  */
 static constexpr inline i32 N_STONES_TO_WIN     = static_cast<i32>((N_STONES / 2) + 1);
 
+/**
+ * @brief The number of stones to guarantee at least a draw.
+ */
+static constexpr inline i32 N_STONES_TO_DRAW    = static_cast<i32>(N_STONES / 2);
+
 /**
  * @brief The evaluation weight/score of having a guaranteed winning position.
  */
@@ -1,14 +1,93 @@
 #include "game.h"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
 #include <print>
 
 #include "config.h"
 #include "movelist.h"
+#include "tablebase.h"
 
 Game::Game() : a(true), b(false) {
 
 }
 
+Game::Game(const Side a, const Side b) : a(a), b(b) {
+
+}
+
+std::optional<Game> Game::from_notation(const std::string_view notation) {
+    // Read both sides' seven numbers, then the side to move.
+    std::array<u8, 2 * (N_PITS + 1)>    counts  = {};
+    const char*                         it      = notation.data();
+    const char* const                   end     = notation.data() + notation.size();
+    for (size i = 0; i < counts.size(); i++) {
+        const auto [next, err] = std::from_chars(it, end, counts[i]);
+        if (err != std::errc{})
+            return std::nullopt;
+
+        // Numbers within a side are split by commas, the sides by a slash, and
+        // the side to move by a space.
+        const char separator = i == counts.size() - 1
+            ? ' '
+            : i == N_PITS
+                ? '/'
+                : ',';
+        if (next == end || *next != separator)
+            return std::nullopt;
+        it = next + 1;
+    }
+
+    const std::string_view turn(it, end);
+    if (turn != "a" && turn != "b")
+        return std::nullopt;
+
+    std::array<u8, N_PITS> aPits;
+    std::array<u8, N_PITS> bPits;
+    std::copy_n(counts.begin(), N_PITS, aPits.begin());
+    std::copy_n(counts.begin() + N_PITS + 1, N_PITS, bPits.begin());
+    const Side a = Side::from_pits(aPits, counts[N_PITS], turn == "a");
+    const Side b = Side::from_pits(bPits, counts[2 * N_PITS + 1], turn == "b");
+
+    return from_bits(a.bits(), b.bits());
+}
+
+std::optional<Game> Game::from_bits(const u64 aBits, const u64 bBits) {
+    const Side a = Side::from_bits(aBits);
+    const Side b = Side::from_bits(bBits);
+    if (a.has_turn() == b.has_turn())
+        return std::nullopt;
+
+    // Rebuilding each side from its counts drops any bits outside them.
+    i32 nStones = 0;
+    for (const Side side: { a, b }) {
+        std::array<u8, N_PITS> pits;
+        for (u8 i = 0; i < N_PITS; i++)
+            pits[i] = static_cast<u8>(side.pit(i + 1));
+
+        nStones += side.mancala();
+        for (const u8 pit: pits)
+            nStones += pit;
+        if (Side::from_pits(pits, static_cast<u8>(side.mancala()), side.has_turn()).bits() != side.bits())
+            return std::nullopt;
+    }
+    if (nStones != static_cast<i32>(N_STONES))
+        return std::nullopt;
+
+    return Game(a, b);
+}
+
+std::string Game::to_notation() const {
+    return std::format(
+        "{},{},{},{},{},{},{}/{},{},{},{},{},{},{} {}",
+        a.pit(1), a.pit(2), a.pit(3), a.pit(4), a.pit(5), a.pit(6), a.mancala(),
+        b.pit(1), b.pit(2), b.pit(3), b.pit(4), b.pit(5), b.pit(6), b.mancala(),
+        a.has_turn() ? 'a' : 'b'
+    );
+}
+
 std::tuple<Side, Side> Game::get_sides() const {
     return std::tuple(a, b);
 }
@@ -19,6 +98,13 @@ std::tuple<Side, Side> Game::get_turn_user_opp() const {
         : std::tuple(b, a);
 }
 
+__attribute__((hot))
+u64 Game::hash() const {
+    // Mix each side on its own; combining the raw words lets positions that
+    // differ only in whose turn it is cancel out.
+    return mix(a.bits() ^ mix(b.bits()));
+}
+
 MoveList Game::legal_moves() const {
     if (a.has_turn())
         return MoveList(a);
@@ -26,32 +112,65 @@ MoveList Game::legal_moves() const {
         return MoveList(b);
 }
 
+i32 Game::n_pit_stones() const {
+    return a.n_pit_stones() + b.n_pit_stones();
+}
+
+std::tuple<i32, i32> Game::bounds() const {
+    return bounds(a, b);
+}
+
+bool Game::is_decided() const {
+    const auto [lower, upper] = bounds();
+    return lower == upper;
+}
+
 __attribute__((hot))
-i32 Game::eval() const {
-    i32 score       = 0;
-    i32 aMancala    = a.mancala();
-    i32 bMancala    = b.mancala();
+i32 Game::eval(const Tablebase* tablebase) const {
+    // Use the exact result if it's known.
+    if (tablebase != nullptr) {
+        if (const auto diff = tablebase->probe(*this)) {
+            if (diff.value() > 0)
+                return EW_WINNING;
+            else if (diff.value() < 0)
+                return -EW_WINNING;
+            else
+                return 0;
+        }
+    }
 
-    // Catch an unstoppable win for either player.
-    if (aMancala >= N_STONES_TO_WIN)
-        return EW_WINNING;
-    if (bMancala >= N_STONES_TO_WIN)
-        return -EW_WINNING;
+    // Catch an unstoppable win for either player, or a certain draw.
+    const auto [lower, upper] = bounds();
+    if (lower == upper)
+        return lower;
+
+    i32 score = 0;
 
     // Favor a bountiful mancala.
-    score += (aMancala - bMancala) * EW_STONE_IN_MANCALA;
+    score += (a.mancala() - b.mancala()) * EW_STONE_IN_MANCALA;
     
     // Favor pit control.
     for (u8 i = 1; i <= N_PITS; i++)
         score += (a.pit(i) - b.pit(i)) * EW_STONE_IN_PIT;
 
-    return score;
+    // Never score past what the mancalas already settle.
+    return std::clamp(score, lower, upper);
 }
 
 bool Game::is_pov_turn() const {
     return a.has_turn();
 }
 
+u64 Game::mix(u64 x) {
+    // Splitmix64's finalizer, so similar words spread across the table.
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 29;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 32;
+    return x;
+}
+
 bool Game::is_over() const {
     return !(a.has_moves() && b.has_moves());
 }
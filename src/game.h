@@ -1,11 +1,17 @@
 #pragma once
 
+#include <optional>
+#include <string>
+#include <string_view>
 #include <tuple>
 
+#include "config.h"
 #include "def.h"
 #include "movelist.h"
 #include "side.h"
 
+class Tablebase;
+
 class Game {
 private:
     /**
@@ -21,6 +27,28 @@ private:
 public:
     Game();
 
+    /**
+     * @brief A game with the given PoV and upper sides.
+     */
+    explicit Game(Side a, Side b);
+
+    /**
+     * @brief Returns the game in the given notation, or `nullopt` if it isn't
+     * valid notation of a position holding every stone.
+     *
+     * @details The notation is the PoV side's pits 1 to 6 and mancala, then the
+     * upper side's, then the side to move, "a" or "b". The start position is
+     * "4,4,4,4,4,4,0/4,4,4,4,4,4,0 a".
+     */
+    static std::optional<Game> from_notation(std::string_view notation);
+
+    /**
+     * @brief Returns the game with the given PoV and upper sides' bits, or
+     * `nullopt` if they aren't a position holding every stone with exactly one
+     * side to move.
+     */
+    static std::optional<Game> from_bits(u64 a, u64 b);
+
     /**
      * @brief Returns an iterator of the current legal moves.
      */
@@ -36,13 +64,68 @@ public:
      */
     std::tuple<Side, Side> get_turn_user_opp() const;
 
+    /**
+     * @brief Returns the game in the notation read by `from_notation`.
+     */
+    std::string to_notation() const;
+
+    /**
+     * @brief Returns a hash of the game state, including whose turn it is.
+     */
+    u64 hash() const;
+
+    /**
+     * @brief Returns the number of stones in both sides' pits.
+     */
+    i32 n_pit_stones() const;
+
+    /**
+     * @brief Returns the lowest and highest evaluations the final result can
+     * have from the PoV side's perspective in a tuple, each a loss, draw or win.
+     *
+     * @details Stones in a mancala stay there, so a side holding half of them
+     * can't lose, and one holding more can't be caught.
+     */
+    std::tuple<i32, i32> bounds() const;
+
+    /**
+     * @brief Returns `bounds` for a game of the given sides, from the first
+     * side's perspective.
+     */
+    static inline std::tuple<i32, i32> bounds(const Side x, const Side y) {
+        const i32 xMancala = x.mancala();
+        const i32 yMancala = y.mancala();
+
+        const i32 lower = xMancala >= N_STONES_TO_WIN
+            ? EW_WINNING
+            : xMancala >= N_STONES_TO_DRAW
+                ? 0
+                : -EW_WINNING;
+        const i32 upper = yMancala >= N_STONES_TO_WIN
+            ? -EW_WINNING
+            : yMancala >= N_STONES_TO_DRAW
+                ? 0
+                : EW_WINNING;
+
+        return std::tuple(lower, upper);
+    }
+
+    /**
+     * @brief Returns `true` if the mancalas already settle the result.
+     */
+    bool is_decided() const;
+
     /**
      * @brief Returns an evaluation of the current position.
      * 
      * The evaluation comes from the human's PoV, meaning a larger score is
      * beneficial to the human, a lower score is beneficial for the bot.
+     *
+     * If a tablebase is given and covers the position, the exact result is
+     * returned instead of the heuristic, which is otherwise kept within
+     * `bounds`.
      */
-    i32 eval() const;
+    i32 eval(const Tablebase* tablebase = nullptr) const;
 
     /**
      * @brief Returns `true` if it's the PoV side's turn, `false` if not.
@@ -73,4 +156,10 @@ public:
      * If called with an illegal move, the turns will just be swapped.
      */
     void make_move_unchecked(u64 move);
+
+private:
+    /**
+     * @brief Scrambles a word's bits for hashing.
+     */
+    static u64 mix(u64 x);
 };
@@ -1,7 +1,16 @@
+#include <string_view>
+
+#include "bench.h"
 #include "cli.h"
 #include "def.h"
 
-i32 main() {
+i32 main(i32 argc, char** argv) {
+    // Run the search benchmark and exit if asked to.
+    if (argc > 1 && std::string_view(argv[1]) == "--bench") {
+        Bench::search(Bench::SEARCH_DEPTH);
+        return 0;
+    }
+
     CLI cli;
     while (cli.is_open())
         cli.process();
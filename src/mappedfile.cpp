@@ -0,0 +1,60 @@
+#include "mappedfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : mapping(nullptr), mappingSize(0) {
+
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    const i32 fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the file is closed.
+    const size  fileSize    = static_cast<size>(info.st_size);
+    void*       data        = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    mapping     = data;
+    mappingSize = fileSize;
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    mapping     = nullptr;
+    mappingSize = 0;
+}
+
+bool MappedFile::is_open() const {
+    return mapping != nullptr;
+}
+
+const u8* MappedFile::data() const {
+    return static_cast<const u8*>(mapping);
+}
+
+size MappedFile::size_bytes() const {
+    return mappingSize;
+}
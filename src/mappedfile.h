@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include "def.h"
+
+class MappedFile {
+    /**
+     * @brief The mapped file, or `nullptr` if none is open.
+     */
+    void* mapping;
+
+    /**
+     * @brief The size of the mapped file in bytes.
+     */
+    size mappingSize;
+
+public:
+    MappedFile();
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps the given file read-only, replacing any open one.
+     *
+     * @return `true` on success, `false` if the file is missing or empty.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmaps the open file, if any.
+     */
+    void close();
+
+    /**
+     * @brief Returns `true` if a file is mapped.
+     */
+    bool is_open() const;
+
+    /**
+     * @brief Returns the start of the mapped file, or `nullptr` if none is open.
+     */
+    const u8* data() const;
+
+    /**
+     * @brief Returns the size of the mapped file in bytes.
+     */
+    size size_bytes() const;
+};
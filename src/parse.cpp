@@ -0,0 +1,23 @@
+#include "parse.h"
+
+#include <charconv>
+
+std::optional<u32> parse_uint(const std::string& s) {
+    // Attempt to parse to integer, rejecting anything after it.
+    u32 n = 0;
+    const auto [end, err] = std::from_chars(s.data(), s.data() + s.size(), n);
+    if (err != std::errc{} || end != s.data() + s.size())
+        return std::nullopt;
+
+    return n;
+}
+
+std::optional<u64> parse_ulong(const std::string& s) {
+    // Attempt to parse to integer, rejecting anything after it.
+    u64 n = 0;
+    const auto [end, err] = std::from_chars(s.data(), s.data() + s.size(), n);
+    if (err != std::errc{} || end != s.data() + s.size())
+        return std::nullopt;
+
+    return n;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "def.h"
+
+/**
+ * @brief Parses the whole string to a `u32`.
+ *
+ * @return The parsed integer, or `nullopt` if the string isn't one or doesn't
+ * fit.
+ */
+std::optional<u32> parse_uint(const std::string& s);
+
+/**
+ * @brief Parses the whole string to a `u64`.
+ *
+ * @return The parsed integer, or `nullopt` if the string isn't one or doesn't
+ * fit.
+ */
+std::optional<u64> parse_ulong(const std::string& s);
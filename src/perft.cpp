@@ -0,0 +1,130 @@
+#include "perft.h"
+
+#include <bit>
+#include <thread>
+
+#include "movelist.h"
+
+Perft::Cache::Cache(const size mb) : slots(), mask(0) {
+    if (mb == 0)
+        return;
+
+    const size nSlots = std::bit_floor((mb << 20) / sizeof(Slot));
+    slots   = std::make_unique<Slot[]>(nSlots);
+    mask    = nSlots - 1;
+}
+
+std::optional<u64> Perft::Cache::probe(const u64 key) const {
+    const Slot& slot    = slots[key & mask];
+    const u64   count   = slot.count.load(std::memory_order_relaxed);
+    const u64   check   = slot.check.load(std::memory_order_relaxed);
+
+    // Empty slots hold a count of 0, which no cached subtree has.
+    if (count != 0 && (check ^ count) == key)
+        return count;
+    else
+        return std::nullopt;
+}
+
+void Perft::Cache::store(const u64 key, const u64 count) {
+    Slot& slot = slots[key & mask];
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.check.store(key ^ count, std::memory_order_relaxed);
+}
+
+u64 Perft::count(const Game game, const i32 depth, const Options& options) {
+    Cache cache(options.hashMb);
+    return count_parallel(Position(game), depth, options.nThreads, cache);
+}
+
+std::vector<std::tuple<u8, u64>> Perft::divide(const Game game, const i32 depth, const Options& options) {
+    Cache                               cache(options.hashMb);
+    std::vector<std::tuple<u8, u64>>    counts;
+    if (depth < 1 || game.is_over())
+        return counts;
+
+    for (const auto move: game.legal_moves()) {
+        Game child = game;
+        child.make_move_unchecked(move);
+        counts.emplace_back(move, count_parallel(Position(child), depth - 1, options.nThreads, cache));
+    }
+
+    return counts;
+}
+
+u64 Perft::count_parallel(const Position position, const i32 depth, const size nThreads, Cache& cache) {
+    if (nThreads <= 1 || depth <= SPLIT_DEPTH)
+        return count_serial(position, depth, cache);
+
+    // Expand the first plies so there are enough subtrees to share.
+    std::vector<Position> positions;
+    expand(position, SPLIT_DEPTH, positions);
+
+    std::atomic<size>           next    = 0;
+    std::atomic<u64>            total   = 0;
+    std::vector<std::thread>    threads;
+    const auto work = [&](){
+        u64 n = 0;
+        for (size i = next++; i < positions.size(); i = next++)
+            n += count_serial(positions[i], depth - SPLIT_DEPTH, cache);
+        total += n;
+    };
+
+    for (size i = 1; i < nThreads; i++)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread: threads)
+        thread.join();
+
+    return total;
+}
+
+__attribute__((hot))
+u64 Perft::count_serial(const Position position, const i32 depth, Cache& cache) {
+    if (depth == 0)
+        return 1;
+    if (position.is_over())
+        return 0;
+
+    // Every move is a leaf; no need to make them.
+    MoveList moves = position.legal_moves();
+    if (depth == 1)
+        return moves.n_moves();
+
+    const bool  isCached    = cache.is_enabled() && depth >= CACHE_MIN_DEPTH;
+    const u64   key         = isCached ? cache_key(position, depth) : 0;
+    if (isCached)
+        if (const auto n = cache.probe(key))
+            return n.value();
+
+    u64 n = 0;
+    for (const auto move: moves) {
+        Position child = position;
+        child.make_move_unchecked(move);
+        n += count_serial(child, depth - 1, cache);
+    }
+
+    if (isCached && n != 0)
+        cache.store(key, n);
+
+    return n;
+}
+
+void Perft::expand(const Position position, const i32 depth, std::vector<Position>& positions) {
+    if (depth == 0) {
+        positions.push_back(position);
+        return;
+    }
+    if (position.is_over())
+        return;
+
+    for (const auto move: position.legal_moves()) {
+        Position child = position;
+        child.make_move_unchecked(move);
+        expand(child, depth - 1, positions);
+    }
+}
+
+u64 Perft::cache_key(const Position& position, const i32 depth) {
+    return position.hash() ^ (static_cast<u64>(depth) * 0x9E3779B97F4A7C15ULL);
+}
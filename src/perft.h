@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "def.h"
+#include "game.h"
+#include "position.h"
+
+class Perft {
+public:
+    /**
+     * @brief The number of leaf nodes at each depth from the start position,
+     * indexed by depth.
+     */
+    static constexpr inline std::array<u64, 13> REFERENCE = {
+        1,
+        6,
+        35,
+        185,
+        942,
+        4'690,
+        23'233,
+        114'430,
+        563'223,
+        2'767'164,
+        13'561'940,
+        66'243'364,
+        321'607'252,
+    };
+
+    struct Options {
+        /**
+         * @brief The number of threads to count with.
+         */
+        size nThreads;
+
+        /**
+         * @brief The size of the count cache in megabytes, or 0 for none.
+         */
+        size hashMb;
+    };
+
+private:
+    /**
+     * @brief A cache of subtree counts shared by every counting thread.
+     *
+     * @details Slots are lock-free like the transposition table's: the key is
+     * stored XOR-ed with the count, so a torn slot fails the key check.
+     */
+    class Cache {
+        struct Slot {
+            /**
+             * @brief The key XOR-ed with `count`.
+             */
+            std::atomic<u64> check;
+
+            /**
+             * @brief The subtree's leaf count.
+             */
+            std::atomic<u64> count;
+        };
+
+        /**
+         * @brief The cache's slots, or `nullptr` if it is disabled.
+         */
+        std::unique_ptr<Slot[]> slots;
+
+        /**
+         * @brief A bitmask to turn a key into a slot index.
+         */
+        u64 mask;
+
+    public:
+        explicit Cache(size mb);
+
+        /**
+         * @brief Returns `true` if the cache has any slots.
+         */
+        inline bool is_enabled() const {
+            return slots != nullptr;
+        }
+
+        /**
+         * @brief Returns the count stored for the key, if there is one.
+         */
+        std::optional<u64> probe(u64 key) const;
+
+        /**
+         * @brief Stores the count for the key, replacing whatever was in its slot.
+         */
+        void store(u64 key, u64 count);
+    };
+
+    /**
+     * @brief The minimum depth to cache the counts of.
+     *
+     * @details Shallower subtrees are cheaper to count than to look up.
+     */
+    static constexpr inline i32 CACHE_MIN_DEPTH = 3;
+
+    /**
+     * @brief The depth positions are expanded to before being shared among threads.
+     */
+    static constexpr inline i32 SPLIT_DEPTH = 2;
+
+public:
+    /**
+     * @brief Returns the number of positions exactly the given number of plies
+     * from the given one.
+     *
+     * @details Every move is a ply, including those of a chained turn. Games
+     * that end before the depth is reached are not counted.
+     */
+    static u64 count(Game game, i32 depth, const Options& options);
+
+    /**
+     * @brief Returns the count below each legal move, in move order.
+     */
+    static std::vector<std::tuple<u8, u64>> divide(Game game, i32 depth, const Options& options);
+
+private:
+    /**
+     * @brief Counts with the given number of threads, sharing subtrees among
+     * them once the first plies are expanded.
+     */
+    static u64 count_parallel(Position position, i32 depth, size nThreads, Cache& cache);
+
+    /**
+     * @brief Counts on the calling thread.
+     */
+    static u64 count_serial(Position position, i32 depth, Cache& cache);
+
+    /**
+     * @brief Appends the positions exactly the given number of plies from the
+     * given one to `positions`.
+     */
+    static void expand(Position position, i32 depth, std::vector<Position>& positions);
+
+    /**
+     * @brief Returns the cache key of the position searched to the given depth.
+     */
+    static u64 cache_key(const Position& position, i32 depth);
+};
@@ -0,0 +1,56 @@
+#include "position.h"
+
+#include <algorithm>
+
+#include "config.h"
+
+Position::Position() : Position(Game()) {
+
+}
+
+Position::Position(const Game& game) : u(false), o(false), isPovTurn(game.is_pov_turn()) {
+    std::tie(u, o) = game.get_turn_user_opp();
+}
+
+Game Position::to_game() const {
+    return isPovTurn
+        ? Game(u, o)
+        : Game(o, u);
+}
+
+__attribute__((hot))
+u64 Position::hash() const {
+    // Pick the PoV side without branching, for `Game::hash`'s order.
+    const u64 swap  = (u.bits() ^ o.bits()) & (0ULL - !isPovTurn);
+    const u64 a     = u.bits() ^ swap;
+    const u64 b     = o.bits() ^ swap;
+
+    return Game(Side::from_bits(a), Side::from_bits(b)).hash();
+}
+
+__attribute__((hot))
+i32 Position::eval() const {
+    const auto [lower, upper] = Game::bounds(u, o);
+
+    const i32 score = (u.mancala() - o.mancala()) * EW_STONE_IN_MANCALA + (u.n_pit_stones() - o.n_pit_stones()) * EW_STONE_IN_PIT;
+    return std::clamp(score, lower, upper);
+}
+
+__attribute__((hot))
+void Position::make_move_unchecked(const u8 move) {
+    const bool isChain = u.make_move(move, o);
+
+    // Check for game ending.
+    if (is_over()) {
+        u.take_pits();
+        o.take_pits();
+    }
+
+    // Pass the turn by swapping the sides under a mask, toggling their turn
+    // bits on the way.
+    const u64 passMask  = 0ULL - !isChain;
+    const u64 swap      = (u.bits() ^ o.bits()) & passMask;
+    u           = Side::from_bits(u.bits() ^ swap ^ (Side::TURN_BIT & passMask));
+    o           = Side::from_bits(o.bits() ^ swap ^ (Side::TURN_BIT & passMask));
+    isPovTurn   ^= !isChain;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <tuple>
+
+#include "def.h"
+#include "game.h"
+#include "movelist.h"
+#include "side.h"
+
+/**
+ * @brief A game state stored from the side to move's perspective.
+ *
+ * @details `Game` keeps its sides in fixed places and asks their turn bits
+ * who moves; a position keeps the side to move first, swapping the two when
+ * the turn passes, with only a flag remembering which is the PoV side. The
+ * sides still carry their turn bits, so converting back to a `Game` and
+ * hashing give the same results.
+ *
+ * Perft, its benchmark, and the quiescence search use it; the rest of the
+ * search and the solver work on `Game`.
+ */
+class Position {
+private:
+    /**
+     * @brief The side to move.
+     */
+    Side u;
+
+    /**
+     * @brief The side waiting to move.
+     */
+    Side o;
+
+    /**
+     * @brief Is `true` if the side to move is the PoV side.
+     */
+    bool isPovTurn;
+
+public:
+    Position();
+
+    /**
+     * @brief The position of the given game.
+     */
+    explicit Position(const Game& game);
+
+    /**
+     * @brief Returns the game this position is, with the PoV side first.
+     */
+    Game to_game() const;
+
+    /**
+     * @brief Returns the side to move's legal moves.
+     */
+    inline MoveList legal_moves() const {
+        return MoveList(u);
+    }
+
+    /**
+     * @brief Returns the side to move and the other side in a tuple.
+     */
+    inline std::tuple<Side, Side> get_user_opp() const {
+        return std::tuple(u, o);
+    }
+
+    /**
+     * @brief Returns `true` if it's the PoV side's turn, `false` if not.
+     */
+    inline bool is_pov_turn() const {
+        return isPovTurn;
+    }
+
+    /**
+     * @brief Returns `true` if the game is over, `false` if not.
+     */
+    inline bool is_over() const {
+        return !(u.has_moves() && o.has_moves());
+    }
+
+    /**
+     * @brief Returns `true` if the mancalas already settle the result, `false`
+     * if not.
+     */
+    inline bool is_decided() const {
+        const auto [lower, upper] = Game::bounds(u, o);
+        return lower == upper;
+    }
+
+    /**
+     * @brief Returns the same hash as `Game::hash` for the same game.
+     */
+    u64 hash() const;
+
+    /**
+     * @brief Returns `Game::eval` without a tablebase, from the side to
+     * move's perspective.
+     */
+    i32 eval() const;
+
+    /**
+     * @brief Makes the given move without checking if it is legal.
+     */
+    void make_move_unchecked(u8 move);
+};
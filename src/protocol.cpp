@@ -0,0 +1,125 @@
+#include "protocol.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <print>
+
+#include "parse.h"
+
+Protocol::Protocol(AI& ai, const Game& game) : ai(ai), game(game), outputMutex(), isOpen(true) {
+
+}
+
+void Protocol::run() {
+    std::string input;
+    while (isOpen && std::getline(std::cin, input)) {
+        std::istringstream toks(input);
+        std::string cmd;
+        toks >> std::skipws >> cmd;
+        if (cmd.empty())
+            continue;
+        else if (cmd == "isready")
+            send("readyok");
+        else if (cmd == "position")
+            position(toks);
+        else if (cmd == "go")
+            go(toks);
+        else if (cmd == "stop")
+            stop();
+        else if (cmd == "quit")
+            isOpen = false;
+        else
+            send(std::format("info string unknown command {}", cmd));
+    }
+
+    stop();
+}
+
+void Protocol::position(std::istringstream& toks) {
+    // The search must not see the position change under it.
+    stop();
+
+    std::string tok;
+    if (!(toks >> tok) || tok != "startpos") {
+        send(std::format("info string expected startpos, found \"{}\"", tok));
+        return;
+    }
+
+    Game next;
+    if (toks >> tok && tok != "moves") {
+        send(std::format("info string expected moves, found \"{}\"", tok));
+        return;
+    }
+    while (toks >> tok) {
+        const auto move = parse_ulong(tok);
+        if (!move || move.value() < 1 || move.value() > N_PITS || !next.make_move(static_cast<u8>(move.value()))) {
+            send(std::format("info string illegal move {}", tok));
+            return;
+        }
+    }
+
+    game = next;
+}
+
+void Protocol::go(std::istringstream& toks) {
+    stop();
+
+    // No limits means searching until stopped.
+    AI::Limits  limits  = { AI::MAX_DEPTH, 0, 0 };
+    std::string tok;
+    while (toks >> tok) {
+        if (tok == "infinite")
+            continue;
+
+        std::string val;
+        toks >> val;
+        const auto n = parse_ulong(val);
+        if (!n || (tok != "depth" && tok != "movetime" && tok != "nodes")) {
+            send(std::format("info string bad go argument {} {}", tok, val));
+            return;
+        }
+
+        if (tok == "depth")
+            limits.depth = static_cast<i32>(std::min<u64>(n.value(), AI::MAX_DEPTH));
+        else if (tok == "movetime")
+            limits.movetime = n.value();
+        else
+            limits.nodes = n.value();
+    }
+
+    const bool isPovTurn = game.is_pov_turn();
+    ai.start_search(
+        game,
+        limits,
+        [this, isPovTurn](const AI::Result& result){ send_info(result, isPovTurn); },
+        [this](const AI::Result& result){
+            send(result.move != 0 ? std::format("bestmove {}", result.move) : "bestmove none");
+        }
+    );
+}
+
+void Protocol::stop() {
+    ai.stop();
+    ai.wait();
+}
+
+void Protocol::send_info(const AI::Result& result, const bool isPovTurn) {
+    std::string pv;
+    for (size i = 0; i < result.pv.length; i++)
+        pv += std::format(" {}", result.pv.moves[i]);
+
+    send(std::format(
+        "info depth {} score {} nodes {} time {} nps {} pv{}",
+        result.depth, result.mover_score(isPovTurn), result.nodes, result.time,
+        result.nodes * 1000 / std::max<u64>(result.time, 1), pv
+    ));
+}
+
+void Protocol::send(const std::string& line) {
+    std::lock_guard lock(outputMutex);
+    std::println("{}", line);
+    std::fflush(stdout);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "ai.h"
+#include "def.h"
+#include "game.h"
+
+/**
+ * @brief A line-based protocol for driving the engine from another program.
+ *
+ * @details The calling thread reads commands while the AI's search thread
+ * searches, so "stop" and "isready" are answered during a search. Output is
+ * flushed after every line, for reading through pipes.
+ */
+class Protocol {
+private:
+    /**
+     * @brief The engine, shared with the CLI that started the protocol.
+     */
+    AI& ai;
+
+    /**
+     * @brief The position searched by "go".
+     */
+    Game game;
+
+    /**
+     * @brief Guards standard output, written by both threads.
+     */
+    std::mutex outputMutex;
+
+    /**
+     * @brief Is `true` until "quit" or the end of input.
+     */
+    bool isOpen;
+
+public:
+    /**
+     * @brief A protocol searching with the given engine from the given position.
+     */
+    Protocol(AI& ai, const Game& game);
+
+    /**
+     * @brief Reads and answers commands until "quit" or the end of input,
+     * stopping any search before returning.
+     */
+    void run();
+
+private:
+    /**
+     * @brief Handles "position".
+     *
+     * Sets the position to the start, then plays the moves after "moves".
+     */
+    void position(std::istringstream& toks);
+
+    /**
+     * @brief Handles "go".
+     *
+     * Starts a search under the given limits, or until "stop" if there are
+     * none or "infinite" is given, and returns at once.
+     */
+    void go(std::istringstream& toks);
+
+    /**
+     * @brief Handles "stop".
+     *
+     * Ends the search as soon as it has completed an iteration and waits for
+     * its "bestmove".
+     */
+    void stop();
+
+    /**
+     * @brief Prints the progress of a search as an "info" line.
+     */
+    void send_info(const AI::Result& result, bool isPovTurn);
+
+    /**
+     * @brief Prints the line and flushes it.
+     */
+    void send(const std::string& line);
+};
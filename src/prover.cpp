@@ -0,0 +1,280 @@
+#include "prover.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+#include "config.h"
+#include "movelist.h"
+
+Prover::Prover(const size mb) :
+    table(),
+    mask(0),
+    nUsed(0),
+    options(),
+    report(),
+    tablebase(nullptr),
+    startTime(),
+    lastReport(0),
+    root(),
+    isPovAttacker(true),
+    goal(Goal::DRAW),
+    nodes(0),
+    stopped(false)
+{
+    const size nBuckets = std::bit_floor(std::max<size>((mb << 20) / sizeof(Bucket), 1));
+    table   = std::make_unique<Bucket[]>(nBuckets);
+    mask    = nBuckets - 1;
+}
+
+Prover::Result Prover::prove(const Game& game, const Options& options, const Tablebase* tablebase, const Reporter& report) {
+    this->options   = options;
+    this->tablebase = tablebase;
+    this->report    = report;
+    startTime       = Search::Clock::now();
+    lastReport      = 0;
+    root            = game;
+    isPovAttacker   = game.is_pov_turn();
+    nodes           = 0;
+    stopped         = false;
+
+    // Only a side that can't lose might win, so a loss or draw needs one proof
+    // less than a win.
+    Result result = { Outcome::UNKNOWN, 0, 0, 0 };
+    if (prove_goal(Goal::DRAW)) {
+        const u8 drawMove = proving_move();
+        if (prove_goal(Goal::WIN)) {
+            result.outcome  = Outcome::WIN;
+            result.move     = proving_move();
+        } else if (!stopped) {
+            result.outcome  = Outcome::DRAW;
+            result.move     = drawMove;
+        }
+    } else if (!stopped)
+        result.outcome = Outcome::LOSS;
+
+    result.nodes    = nodes;
+    result.time     = elapsed();
+    return result;
+}
+
+str Prover::outcome_name(const Outcome outcome) {
+    switch (outcome) {
+        case Outcome::WIN:      return "win";
+        case Outcome::DRAW:     return "draw";
+        case Outcome::LOSS:     return "loss";
+        case Outcome::UNKNOWN:  return "unknown";
+    }
+
+    return "";
+}
+
+str Prover::goal_name(const Goal goal) {
+    switch (goal) {
+        case Goal::DRAW:    return "draw";
+        case Goal::WIN:     return "win";
+    }
+
+    return "";
+}
+
+bool Prover::prove_goal(const Goal goal) {
+    // Numbers for one goal mean nothing for the other.
+    this->goal = goal;
+    clear();
+
+    auto [proof, disproof] = numbers(root);
+    if (proof != 0 && disproof != 0)
+        std::tie(proof, disproof) = mid(root, INF, INF);
+
+    return !stopped && proof == 0;
+}
+
+__attribute__((hot))
+std::tuple<u32, u32> Prover::mid(const Game& game, const u32 proofLimit, const u32 disproofLimit) {
+    if (++nodes % CHECK_INTERVAL == 0)
+        check_limits();
+
+    const u64   startNodes  = nodes;
+    const bool  isOr        = is_or_node(game);
+
+    std::array<Game, N_PITS>    children    = {};
+    size                        nChildren   = 0;
+    for (const auto move: game.legal_moves()) {
+        children[nChildren] = game;
+        children[nChildren++].make_move_unchecked(move);
+    }
+
+    // Work with the number the side to move minimizes (phi) and the one it
+    // sums (delta), so both kinds of node share the code: at an OR node phi
+    // is the proof number, at an AND node the disproof number. A chain makes
+    // a child the same kind of node as its parent, which only changes which
+    // of its numbers is which.
+    const u32   phiLimit    = isOr ? proofLimit : disproofLimit;
+    const u32   deltaLimit  = isOr ? disproofLimit : proofLimit;
+    u32         phi         = INF;
+    u32         delta       = 0;
+    while (!stopped) {
+        // Combine the children's numbers, finding the most proving child and
+        // the phi of the runner-up.
+        std::array<u32, N_PITS> childPhis   = {};
+        std::array<u32, N_PITS> childDeltas = {};
+        size                    best        = 0;
+        u32                     secondPhi   = INF;
+        u64                     deltaSum    = 0;
+        bool                    isDeltaInf  = false;
+        phi = INF;
+        for (size i = 0; i < nChildren; i++) {
+            const auto [proof, disproof] = numbers(children[i]);
+            childPhis[i]    = isOr ? proof : disproof;
+            childDeltas[i]  = isOr ? disproof : proof;
+
+            if (childPhis[i] < phi) {
+                secondPhi   = phi;
+                phi         = childPhis[i];
+                best        = i;
+            } else if (childPhis[i] < secondPhi)
+                secondPhi = childPhis[i];
+
+            deltaSum    += childDeltas[i];
+            isDeltaInf  |= childDeltas[i] == INF;
+        }
+
+        // Only a settled child makes a sum infinite.
+        delta = isDeltaInf ? INF : static_cast<u32>(std::min<u64>(deltaSum, INF - 1));
+        if (phi >= phiLimit || delta >= deltaLimit)
+            break;
+
+        // Search the best child until it's no longer best, or until this node
+        // passes its limits. Letting it go a fraction past the runner-up saves
+        // switching back and forth between children of similar cost.
+        const u64 childPhiLimit     = std::min<u64>(
+            phiLimit,
+            std::max<u64>(static_cast<u64>(secondPhi) + 1, static_cast<u64>(secondPhi) + secondPhi / EPSILON_DIVISOR)
+        );
+        const u64 childDeltaLimit   = static_cast<u64>(deltaLimit) - delta + childDeltas[best];
+        mid(
+            children[best],
+            static_cast<u32>(isOr ? childPhiLimit : childDeltaLimit),
+            static_cast<u32>(isOr ? childDeltaLimit : childPhiLimit)
+        );
+    }
+
+    const u32 proof     = isOr ? phi : delta;
+    const u32 disproof  = isOr ? delta : phi;
+    if (!stopped)
+        store(game, proof, disproof, nodes - startNodes + 1);
+
+    return std::tuple(proof, disproof);
+}
+
+std::tuple<u32, u32> Prover::numbers(const Game& game) const {
+    // Find the least and most the side proving the goal can end with.
+    auto [lower, upper] = game.bounds();
+    if (tablebase != nullptr && !game.is_over()) {
+        if (const auto diff = tablebase->probe(game)) {
+            lower = diff.value() > 0 ? EW_WINNING : diff.value() < 0 ? -EW_WINNING : 0;
+            upper = lower;
+        }
+    }
+    if (!isPovAttacker)
+        std::tie(lower, upper) = std::tuple(-upper, -lower);
+
+    // The mancalas may settle the goal before the game is over.
+    const i32 needed = goal == Goal::WIN ? EW_WINNING : 0;
+    if (lower >= needed)
+        return std::tuple(0, INF);
+    if (upper < needed)
+        return std::tuple(INF, 0);
+
+    if (const Entry* entry = probe(game))
+        return std::tuple(entry->proof, entry->disproof);
+    else
+        return std::tuple(1, 1);
+}
+
+bool Prover::is_or_node(const Game& game) const {
+    return game.is_pov_turn() == isPovAttacker;
+}
+
+Prover::Bucket& Prover::bucket(const Game& game) const {
+    return table[game.hash() & mask];
+}
+
+const Prover::Entry* Prover::probe(const Game& game) const {
+    const auto [a, b] = game.get_sides();
+    for (const Entry& entry: bucket(game)) {
+        if (entry.a == a.bits() && entry.b == b.bits())
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+void Prover::store(const Game& game, const u32 proof, const u32 disproof, const u64 work) {
+    const auto  [a, b]  = game.get_sides();
+    Bucket&     slots   = bucket(game);
+
+    // Keep the entries that cost the most to find: the position's own if it's
+    // there, otherwise whichever took the least work, empty ones having none.
+    Entry* victim = &slots[0];
+    for (Entry& entry: slots) {
+        if (entry.a == a.bits() && entry.b == b.bits()) {
+            victim = &entry;
+            break;
+        }
+        if (entry.work < victim->work)
+            victim = &entry;
+    }
+
+    if (victim->a == 0 && victim->b == 0)
+        nUsed++;
+    *victim = { a.bits(), b.bits(), proof, disproof, work };
+}
+
+void Prover::clear() {
+    std::fill_n(table.get(), mask + 1, Bucket{});
+    nUsed = 0;
+}
+
+u8 Prover::proving_move() const {
+    for (const auto move: root.legal_moves()) {
+        Game child = root;
+        child.make_move_unchecked(move);
+        if (std::get<0>(numbers(child)) == 0)
+            return move;
+    }
+
+    return 0;
+}
+
+void Prover::check_limits() {
+    const u64 time = elapsed();
+    if (options.nodes > 0 && nodes >= options.nodes)
+        stopped = true;
+    if (options.movetime > 0 && time >= options.movetime)
+        stopped = true;
+
+    if (!report || time < lastReport + REPORT_INTERVAL)
+        return;
+    lastReport = time;
+
+    // The root is an OR node, and its numbers are only stored once its proof
+    // is over, so combine its children's.
+    Progress progress   = { goal, INF, 0, nodes, time, 0 };
+    u64      disproof   = 0;
+    for (const auto move: root.legal_moves()) {
+        Game child = root;
+        child.make_move_unchecked(move);
+        const auto [childProof, childDisproof] = numbers(child);
+        progress.proof  = std::min(progress.proof, childProof);
+        disproof        += childDisproof;
+    }
+    progress.disproof   = static_cast<u32>(std::min<u64>(disproof, INF));
+    progress.hashfull   = static_cast<u32>(nUsed * 1000 / ((mask + 1) * BUCKET_SIZE));
+    report(progress);
+}
+
+u64 Prover::elapsed() const {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(Search::Clock::now() - startTime).count());
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <tuple>
+
+#include "def.h"
+#include "game.h"
+#include "search.h"
+#include "tablebase.h"
+
+class Prover {
+public:
+    /**
+     * @brief The default size of the proof table in megabytes.
+     */
+    static constexpr inline size DEFAULT_MB = 64;
+
+    /**
+     * @brief The result of the game for the side to move under perfect play.
+     */
+    enum class Outcome {
+        WIN,
+        DRAW,
+        LOSS,
+
+        /**
+         * @brief A limit was reached before the result was proved.
+         */
+        UNKNOWN,
+    };
+
+    /**
+     * @brief What a proof is trying to show for the side to move.
+     */
+    enum class Goal {
+        /**
+         * @brief That it can end with at least half the stones.
+         */
+        DRAW,
+
+        /**
+         * @brief That it can end with more than half the stones.
+         */
+        WIN,
+    };
+
+    struct Options {
+        /**
+         * @brief The size of the proof table in megabytes.
+         */
+        size hashMb;
+
+        /**
+         * @brief The time budget in milliseconds, or 0 for no limit.
+         */
+        u64 movetime;
+
+        /**
+         * @brief The node budget, or 0 for no limit.
+         */
+        u64 nodes;
+    };
+
+    /**
+     * @brief The state of a proof in progress.
+     */
+    struct Progress {
+        /**
+         * @brief What the current proof is trying to show.
+         */
+        Goal goal;
+
+        /**
+         * @brief The root's proof number: a lower bound on the positions
+         * still to prove to show the goal.
+         */
+        u32 proof;
+
+        /**
+         * @brief The root's disproof number: a lower bound on the positions
+         * still to prove to refute the goal.
+         */
+        u32 disproof;
+
+        /**
+         * @brief The number of nodes expanded over every proof so far.
+         */
+        u64 nodes;
+
+        /**
+         * @brief The time since the first proof started in milliseconds.
+         */
+        u64 time;
+
+        /**
+         * @brief The permille of the table's entries in use.
+         */
+        u32 hashfull;
+    };
+
+    struct Result {
+        Outcome outcome;
+
+        /**
+         * @brief A move achieving the outcome, or 0 for a loss, an unknown
+         * outcome, or if the proof's entries were overwritten.
+         */
+        u8 move;
+
+        /**
+         * @brief The number of nodes expanded over every proof.
+         */
+        u64 nodes;
+
+        /**
+         * @brief The time taken in milliseconds.
+         */
+        u64 time;
+    };
+
+    using Reporter = std::function<void(const Progress&)>;
+
+private:
+    /**
+     * @brief The proof or disproof number of a position that is settled.
+     */
+    static constexpr inline u32 INF = std::numeric_limits<u32>::max();
+
+    /**
+     * @brief The number of entries sharing a bucket; a store replaces the one
+     * with the least work.
+     */
+    static constexpr inline size BUCKET_SIZE = 4;
+
+    /**
+     * @brief A child is searched until its phi passes the runner-up's by this
+     * fraction (df-pn(1 + 1/`EPSILON_DIVISOR`)), rather than by one.
+     */
+    static constexpr inline u32 EPSILON_DIVISOR = 4;
+
+    /**
+     * @brief The number of nodes between checks of the limits.
+     */
+    static constexpr inline u64 CHECK_INTERVAL = 4096;
+
+    /**
+     * @brief The time between progress reports in milliseconds.
+     */
+    static constexpr inline u64 REPORT_INTERVAL = 1000;
+
+    /**
+     * @brief The proof numbers of a position.
+     */
+    struct Entry {
+        /**
+         * @brief The position's words, both 0 for an empty entry.
+         */
+        u64 a;
+        u64 b;
+
+        u32 proof;
+        u32 disproof;
+
+        /**
+         * @brief The nodes expanded below the position, a measure of what it
+         * would cost to find its numbers again.
+         */
+        u64 work;
+    };
+
+    using Bucket = std::array<Entry, BUCKET_SIZE>;
+
+    /**
+     * @brief The table of proof numbers, keyed on both of a position's words.
+     */
+    std::unique_ptr<Bucket[]> table;
+
+    /**
+     * @brief A bitmask to turn a hash into a bucket index.
+     */
+    u64 mask;
+
+    /**
+     * @brief The number of entries in use.
+     */
+    u64 nUsed;
+
+    /**
+     * @brief The options of the current proof.
+     */
+    Options options;
+
+    /**
+     * @brief Receives progress reports.
+     */
+    Reporter report;
+
+    /**
+     * @brief The tablebase to look up positions in, if one is loaded.
+     */
+    const Tablebase* tablebase;
+
+    /**
+     * @brief When the first proof started.
+     */
+    Search::Clock::time_point startTime;
+
+    /**
+     * @brief When progress was last reported.
+     */
+    u64 lastReport;
+
+    /**
+     * @brief The root of the current proof.
+     */
+    Game root;
+
+    /**
+     * @brief Is `true` if the side to move at the root has the PoV.
+     */
+    bool isPovAttacker;
+
+    /**
+     * @brief What the current proof is trying to show.
+     */
+    Goal goal;
+
+    /**
+     * @brief The number of nodes expanded over every proof.
+     */
+    u64 nodes;
+
+    /**
+     * @brief Is `true` once a limit was reached.
+     */
+    bool stopped;
+
+public:
+    explicit Prover(size mb = DEFAULT_MB);
+
+    /**
+     * @brief Proves the position won, drawn, or lost for the side to move by
+     * depth-first proof-number search (df-pn).
+     *
+     * @details The three-valued result takes two proofs: first whether the
+     * side to move can avoid losing, and if so whether it can win.
+     */
+    Result prove(const Game& game, const Options& options, const Tablebase* tablebase, const Reporter& report = {});
+
+    /**
+     * @brief Returns the name of the outcome.
+     */
+    static str outcome_name(Outcome outcome);
+
+    /**
+     * @brief Returns the name of the goal.
+     */
+    static str goal_name(Goal goal);
+
+private:
+    /**
+     * @brief Runs one proof of the goal from the root.
+     *
+     * @return `true` if the goal was proved, `false` if it was refuted or a
+     * limit was reached.
+     */
+    bool prove_goal(Goal goal);
+
+    /**
+     * @brief Expands the position until its proof number reaches `proofLimit`
+     * or its disproof number reaches `disproofLimit`, storing the numbers.
+     *
+     * @return The position's proof and disproof numbers in a tuple.
+     */
+    std::tuple<u32, u32> mid(const Game& game, u32 proofLimit, u32 disproofLimit);
+
+    /**
+     * @brief Returns the position's proof and disproof numbers in a tuple: 0
+     * and `INF` or `INF` and 0 if it's settled, as stored if not, or 1 and 1
+     * if it's new.
+     */
+    std::tuple<u32, u32> numbers(const Game& game) const;
+
+    /**
+     * @brief Returns `true` if the side trying to prove the goal is to move.
+     */
+    bool is_or_node(const Game& game) const;
+
+    /**
+     * @brief Returns the bucket holding the position.
+     */
+    Bucket& bucket(const Game& game) const;
+
+    /**
+     * @brief Returns the entry for the position, if it's in the table.
+     */
+    const Entry* probe(const Game& game) const;
+
+    /**
+     * @brief Stores the position's numbers, replacing the entry with the least
+     * work in its bucket if the position isn't there.
+     */
+    void store(const Game& game, u32 proof, u32 disproof, u64 work);
+
+    /**
+     * @brief Empties the table.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the move the current proof proved the goal by, or 0 if
+     * none is in the table.
+     */
+    u8 proving_move() const;
+
+    /**
+     * @brief Sets `stopped` if a limit was reached, and reports progress when
+     * due.
+     */
+    void check_limits();
+
+    /**
+     * @brief Returns the time since the first proof started in milliseconds.
+     */
+    u64 elapsed() const;
+};
@@ -0,0 +1,161 @@
+#include "rockhop.h"
+
+#include <algorithm>
+#include <array>
+#include <new>
+
+#include "ai.h"
+#include "config.h"
+#include "def.h"
+#include "game.h"
+#include "movelist.h"
+#include "side.h"
+
+static_assert(ROCKHOP_N_PITS == N_PITS);
+static_assert(ROCKHOP_N_STONES == N_STONES);
+static_assert(ROCKHOP_MAX_DEPTH == AI::MAX_DEPTH);
+
+struct rockhop_position {
+    Game game;
+};
+
+struct rockhop_context {
+    AI ai;
+
+    explicit rockhop_context(const size hashMb) : ai(hashMb) {
+
+    }
+};
+
+// Exceptions must not cross the C boundary: allocating, starting threads, and
+// mapping files can throw, so every function that does turns any exception
+// into NULL or 0.
+
+rockhop_position* rockhop_position_new(void) {
+    return new (std::nothrow) rockhop_position{ Game() };
+}
+
+rockhop_position* rockhop_position_copy(const rockhop_position* position) {
+    return new (std::nothrow) rockhop_position{ position->game };
+}
+
+void rockhop_position_free(rockhop_position* position) {
+    delete position;
+}
+
+int rockhop_position_set_board(rockhop_position* position, const rockhop_board* board) {
+    if (board->to_move > 1)
+        return 0;
+
+    u64 nStones = 0;
+    for (size player = 0; player < 2; player++) {
+        nStones += board->mancalas[player];
+        for (size i = 0; i < N_PITS; i++)
+            nStones += board->pits[player][i];
+    }
+    if (nStones != N_STONES)
+        return 0;
+
+    // Player 0 is the PoV side, as at the start.
+    std::array<u8, N_PITS> aPits;
+    std::array<u8, N_PITS> bPits;
+    std::copy_n(board->pits[0], N_PITS, aPits.begin());
+    std::copy_n(board->pits[1], N_PITS, bPits.begin());
+    position->game = Game(
+        Side::from_pits(aPits, board->mancalas[0], board->to_move == 0),
+        Side::from_pits(bPits, board->mancalas[1], board->to_move == 1)
+    );
+
+    return 1;
+}
+
+void rockhop_position_get_board(const rockhop_position* position, rockhop_board* board) {
+    const auto [a, b] = position->game.get_sides();
+    for (u8 i = 0; i < N_PITS; i++) {
+        board->pits[0][i] = static_cast<u8>(a.pit(i + 1));
+        board->pits[1][i] = static_cast<u8>(b.pit(i + 1));
+    }
+    board->mancalas[0]  = static_cast<u8>(a.mancala());
+    board->mancalas[1]  = static_cast<u8>(b.mancala());
+    board->to_move      = position->game.is_pov_turn() ? 0 : 1;
+}
+
+int rockhop_position_make_move(rockhop_position* position, const int move) {
+    if (move < 1 || move > static_cast<int>(N_PITS) || position->game.is_over())
+        return 0;
+
+    return position->game.make_move(static_cast<u64>(move)) ? 1 : 0;
+}
+
+int rockhop_position_legal_moves(const rockhop_position* position, int moves[ROCKHOP_N_PITS]) {
+    if (position->game.is_over())
+        return 0;
+
+    int n = 0;
+    for (const auto move: position->game.legal_moves())
+        moves[n++] = move;
+    std::sort(moves, moves + n);
+
+    return n;
+}
+
+int rockhop_position_is_over(const rockhop_position* position) {
+    return position->game.is_over() ? 1 : 0;
+}
+
+rockhop_context* rockhop_context_new(const size_t hash_mb, const unsigned threads) {
+    try {
+        rockhop_context* context = new rockhop_context(hash_mb);
+        context->ai.set_threads(threads);
+        return context;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void rockhop_context_free(rockhop_context* context) {
+    delete context;
+}
+
+void rockhop_context_clear(rockhop_context* context) {
+    context->ai.get_table().clear();
+}
+
+int rockhop_context_load_tablebase(rockhop_context* context, const char* path) {
+    try {
+        return context->ai.get_tablebase().load(path) ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+int rockhop_search(rockhop_context* context, const rockhop_position* position, const rockhop_limits* limits, rockhop_result* result) {
+    const Game&         game        = position->game;
+    const AI::Limits    aiLimits    = {
+        limits->depth > 0 ? std::min(limits->depth, AI::MAX_DEPTH) : AI::MAX_DEPTH,
+        limits->movetime,
+        limits->nodes
+    };
+
+    AI::Result found = {};
+    try {
+        found = context->ai.find_move(game, aiLimits);
+    } catch (...) {
+        return 0;
+    }
+
+    result->move        = static_cast<int32_t>(found.move);
+    result->score       = found.mover_score(game.is_pov_turn());
+    result->depth       = found.depth;
+    result->is_exact    = found.isExact ? 1 : 0;
+    result->nodes       = found.nodes;
+    result->time        = found.time;
+    result->pv_length   = static_cast<int32_t>(found.pv.length);
+    std::copy_n(found.pv.moves.begin(), found.pv.length, result->pv);
+
+    return 1;
+}
+
+void rockhop_stop(rockhop_context* context) {
+    context->ai.stop();
+}
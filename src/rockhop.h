@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+ * @file
+ * @brief The C interface of librockhop, for embedding the engine.
+ *
+ * @details Positions and contexts are separate objects, and the library keeps
+ * no global state and prints nothing. Any number of contexts can search at
+ * once on different threads. A position or context must only be used by one
+ * thread at a time, except for `rockhop_stop`, which any thread may call.
+ *
+ * Players are numbered 0 (the first to move from the start) and 1, and pits
+ * by their index from 1 to 6.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ROCKHOP_API __attribute__((visibility("default")))
+
+/**
+ * @brief The number of pits on each player's side.
+ */
+#define ROCKHOP_N_PITS 6
+
+/**
+ * @brief The number of stones in play.
+ */
+#define ROCKHOP_N_STONES 48
+
+/**
+ * @brief The most moves in a search result's line.
+ */
+#define ROCKHOP_MAX_DEPTH 64
+
+/**
+ * @brief A game state.
+ */
+typedef struct rockhop_position rockhop_position;
+
+/**
+ * @brief A search engine with its own transposition table, tablebase, and
+ * settings.
+ */
+typedef struct rockhop_context rockhop_context;
+
+/**
+ * @brief The stones on the board and whose turn it is.
+ */
+typedef struct rockhop_board {
+    /**
+     * @brief Each player's pits, index 0 being pit 1.
+     */
+    uint8_t pits[2][ROCKHOP_N_PITS];
+
+    /**
+     * @brief Each player's mancala.
+     */
+    uint8_t mancalas[2];
+
+    /**
+     * @brief The player to move, 0 or 1.
+     */
+    uint8_t to_move;
+} rockhop_board;
+
+typedef struct rockhop_limits {
+    /**
+     * @brief The maximum depth, or 0 for no cap.
+     */
+    int32_t depth;
+
+    /**
+     * @brief The time budget in milliseconds, or 0 for no limit.
+     */
+    uint64_t movetime;
+
+    /**
+     * @brief The node budget, or 0 for no limit.
+     */
+    uint64_t nodes;
+} rockhop_limits;
+
+typedef struct rockhop_result {
+    /**
+     * @brief The best move, or 0 if the game is over.
+     */
+    int32_t move;
+
+    /**
+     * @brief The evaluation from the perspective of the player to move.
+     */
+    int32_t score;
+
+    /**
+     * @brief The depth of the last completed iteration.
+     */
+    int32_t depth;
+
+    /**
+     * @brief Is 1 if the position was solved to the end of the game, 0 if not.
+     */
+    int32_t is_exact;
+
+    uint64_t nodes;
+
+    /**
+     * @brief The time taken in milliseconds.
+     */
+    uint64_t time;
+
+    /**
+     * @brief The expected line, starting with `move`.
+     */
+    uint8_t pv[ROCKHOP_MAX_DEPTH];
+
+    /**
+     * @brief The number of moves in `pv`.
+     */
+    int32_t pv_length;
+} rockhop_result;
+
+/**
+ * @brief Returns a new position at the start of the game, or NULL if out of
+ * memory.
+ */
+ROCKHOP_API rockhop_position* rockhop_position_new(void);
+
+/**
+ * @brief Returns a new copy of the position, or NULL if out of memory.
+ */
+ROCKHOP_API rockhop_position* rockhop_position_copy(const rockhop_position* position);
+
+/**
+ * @brief Frees the position. Does nothing given NULL.
+ */
+ROCKHOP_API void rockhop_position_free(rockhop_position* position);
+
+/**
+ * @brief Sets the position to the board.
+ *
+ * @return 1 if the board holds `ROCKHOP_N_STONES` stones and a valid player
+ * to move, 0 if not, leaving the position unchanged.
+ */
+ROCKHOP_API int rockhop_position_set_board(rockhop_position* position, const rockhop_board* board);
+
+/**
+ * @brief Writes the position's board to `board`.
+ */
+ROCKHOP_API void rockhop_position_get_board(const rockhop_position* position, rockhop_board* board);
+
+/**
+ * @brief Makes the move for the player to move, which keeps the turn if the
+ * move ends in its mancala.
+ *
+ * @return 1 if the move was legal, 0 if not, leaving the position unchanged.
+ */
+ROCKHOP_API int rockhop_position_make_move(rockhop_position* position, int move);
+
+/**
+ * @brief Writes the legal moves to `moves` in ascending order.
+ *
+ * @return The number of legal moves, 0 if the game is over.
+ */
+ROCKHOP_API int rockhop_position_legal_moves(const rockhop_position* position, int moves[ROCKHOP_N_PITS]);
+
+/**
+ * @brief Returns 1 if the game is over, 0 if not.
+ */
+ROCKHOP_API int rockhop_position_is_over(const rockhop_position* position);
+
+/**
+ * @brief Returns a new context with a transposition table of the given size
+ * in megabytes (at least one entry) searching on the given number of threads,
+ * or NULL if it could not be made.
+ */
+ROCKHOP_API rockhop_context* rockhop_context_new(size_t hash_mb, unsigned threads);
+
+/**
+ * @brief Frees the context. Does nothing given NULL.
+ *
+ * @warning The context must not be searching.
+ */
+ROCKHOP_API void rockhop_context_free(rockhop_context* context);
+
+/**
+ * @brief Empties the context's transposition table, as for a new game.
+ */
+ROCKHOP_API void rockhop_context_clear(rockhop_context* context);
+
+/**
+ * @brief Loads the endgame tablebase file at the given path into the context.
+ *
+ * @return 1 if it was loaded, 0 if not.
+ */
+ROCKHOP_API int rockhop_context_load_tablebase(rockhop_context* context, const char* path);
+
+/**
+ * @brief Searches the position with the context until the limits, or until
+ * `rockhop_stop`, and writes the result of the last completed iteration to
+ * `result`.
+ *
+ * @details Runs on the calling thread, and on helper threads if the context
+ * has more than one.
+ *
+ * @return 1 if the search ran, 0 if it failed, out of memory or unable to
+ * start its threads.
+ */
+ROCKHOP_API int rockhop_search(rockhop_context* context, const rockhop_position* position, const rockhop_limits* limits, rockhop_result* result);
+
+/**
+ * @brief Ends the context's search as soon as it has completed an iteration.
+ *
+ * @details Safe to call from any thread. Has no effect on a search that starts
+ * afterward.
+ */
+ROCKHOP_API void rockhop_stop(rockhop_context* context);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1146 @@
+#include "search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <span>
+#include <thread>
+#include <utility>
+
+#include "batcheval.h"
+#include "movelist.h"
+
+/**
+ * @brief A score beyond any evaluation, which can be negated safely.
+ */
+static constexpr i32 SCORE_INF = 1'000'000'000;
+
+Search::ScoredMove::ScoredMove(size i, i32 score) : i(i), score(score) {
+
+}
+
+void Search::Line::set(const u8 move, const Line& rest) {
+    moves[0] = move;
+    std::copy(rest.moves.begin(), rest.moves.begin() + rest.length, moves.begin() + 1);
+    length = rest.length + 1;
+}
+
+void Search::Line::set(const std::span<const u8> first, const Line& rest) {
+    std::copy(first.begin(), first.end(), moves.begin());
+    std::copy(rest.moves.begin(), rest.moves.begin() + rest.length, moves.begin() + first.size());
+    length = first.size() + rest.length;
+}
+
+void Search::Stats::add(const Stats& other) {
+    evals       += other.evals;
+    ttProbes    += other.ttProbes;
+    ttHits      += other.ttHits;
+    for (size i = 0; i < N_PITS; i++)
+        cutoffs[i] += other.cutoffs[i];
+}
+
+u64 Search::Stats::n_cutoffs() const {
+    u64 n = 0;
+    for (const auto nAt: cutoffs)
+        n += nAt;
+
+    return n;
+}
+
+Search::Shared::Shared(TTable& table, const Limits& limits) :
+    table(table),
+    limits(limits),
+    startTime(Clock::now()),
+    stop(false),
+    halt(nullptr),
+    nodes(0),
+    tbProbes(0),
+    tbHits(0),
+    statsMutex(),
+    stats(),
+    report(),
+    pool(nullptr),
+    searches(nullptr),
+    tablebase(nullptr),
+    driver(Driver::ASPIRATION),
+    quiescence(true),
+    deterministic(false)
+{
+
+}
+
+Search::SplitPoint::SplitPoint(
+    const SplitPoint* parent,
+    i32 a,
+    i32 b,
+    i32 score,
+    u8 bestMove,
+    bool isWindowFixed,
+    size pending
+) :
+    parent(parent),
+    mutex(),
+    a(a),
+    b(b),
+    score(score),
+    bestMove(bestMove),
+    pv(),
+    isWindowFixed(isWindowFixed),
+    cutoff(false),
+    pending(pending)
+{
+
+}
+
+Search::Search(Shared& shared, const size id) :
+    shared(shared),
+    id(id),
+    nodes(0),
+    nodesShared(0),
+    tbProbes(0),
+    tbHits(0),
+    stats(),
+    pv(),
+    prevPv(),
+    followPv(false),
+    killers(),
+    history(),
+    counterMoves(),
+    lastMoves(),
+    nextCheck(0),
+    canStop(false)
+{
+
+}
+
+Search::Result Search::run(const Game game) {
+    const Limits&               limits      = shared.limits;
+    const auto                  entry       = shared.deterministic ? std::nullopt : shared.table.probe(game.hash());
+    MoveList                    rootMoves   = get_sorted_moves(game, entry ? entry->move : 0, 0, 0);
+    std::array<i32, N_PITS>     rootScores  = {};
+    const i32                   maxDepth    = std::clamp(limits.depth, 1, MAX_DEPTH);
+    const bool                  isMain      = id == 0;
+    Result                      result      = {};
+    std::array<u64, 2>          prevNodes   = {};
+    i32                         guess       = 0;
+
+    for (i32 depth = isMain ? 1 : 1 + static_cast<i32>(id % 2); depth <= maxDepth; depth++) {
+        const auto  iterStart   = Clock::now();
+        const u64   iterNodes0  = nodes;
+        const auto  [best, score] = search_iteration(game, rootMoves, rootScores, depth, guess);
+
+        // Only completed iterations can be trusted.
+        if (stopped())
+            break;
+
+        // Report the score from the PoV side's perspective.
+        result.move     = rootMoves[best];
+        result.score    = game.is_pov_turn() ? score : -score;
+        result.pv       = pv[0];
+        result.depth    = depth;
+        result.iterTime = static_cast<u64>(elapsed_ms(iterStart));
+        canStop         = true;
+
+        if (isMain && shared.report)
+            shared.report(progress(result, iterStart));
+
+        // Search the best moves of this iteration first in the next one.
+        order_root_moves(game, rootMoves, rootScores, best);
+        prevPv  = pv[0];
+        guess   = score;
+
+        // A decided game won't change with more depth.
+        if (is_decided(score))
+            break;
+
+        // Helpers keep going until the main thread is done.
+        if (!isMain)
+            continue;
+
+        // Predict the cost of the next iteration from the effective branching
+        // factor, smoothed over two iterations since one can be skewed by hits.
+        const u64   iterNodes   = nodes - iterNodes0;
+        const f64   ebf         = prevNodes[0] > 0
+            ? std::clamp(std::sqrt(static_cast<f64>(iterNodes) / static_cast<f64>(prevNodes[0])), 1.0, MAX_EBF)
+            : MAX_EBF;
+        const f64   iterMs      = elapsed_ms(iterStart);
+        const f64   allNodes    = static_cast<f64>(shared.nodes.load(std::memory_order_relaxed) + nodes - nodesShared);
+        const f64   nThreadsEst = std::max(1.0, allNodes / static_cast<f64>(nodes));
+        prevNodes[0] = prevNodes[1];
+        prevNodes[1] = iterNodes;
+
+        if (limits.movetime > 0 && elapsed_ms(shared.startTime) + iterMs * ebf > static_cast<f64>(limits.movetime))
+            break;
+        if (limits.nodes > 0 && allNodes + static_cast<f64>(iterNodes) * nThreadsEst * ebf > static_cast<f64>(limits.nodes))
+            break;
+    }
+
+    // The main thread finishing ends the search for everyone.
+    if (isMain)
+        shared.stop.store(true, std::memory_order_relaxed);
+    share_nodes();
+
+    return result;
+}
+
+void Search::share_nodes() {
+    shared.nodes.fetch_add(nodes - nodesShared, std::memory_order_relaxed);
+    shared.tbProbes.fetch_add(tbProbes, std::memory_order_relaxed);
+    shared.tbHits.fetch_add(tbHits, std::memory_order_relaxed);
+    nodesShared = nodes;
+    tbProbes    = 0;
+    tbHits      = 0;
+    share_stats();
+}
+
+bool Search::aborted(const SplitPoint* sp) {
+    for (; sp != nullptr; sp = sp->parent)
+        if (sp->cutoff.load(std::memory_order_relaxed))
+            return true;
+
+    return false;
+}
+
+std::tuple<size, i32> Search::search_iteration(
+    const Game                      game,
+    MoveList&                       moves,
+    std::array<i32, N_PITS>&        scores,
+    const i32                       depth,
+    const i32                       guess
+) {
+    switch (shared.driver) {
+        case Driver::FULL_WINDOW:   return search_root(game, moves, scores, depth, -SCORE_INF, SCORE_INF);
+        case Driver::ASPIRATION:    return search_aspiration(game, moves, scores, depth, guess);
+        case Driver::MTDF:          return search_mtdf(game, moves, scores, depth, guess);
+    }
+
+    return std::tuple(0, 0);
+}
+
+std::tuple<size, i32> Search::search_aspiration(
+    const Game                      game,
+    MoveList&                       moves,
+    std::array<i32, N_PITS>&        scores,
+    const i32                       depth,
+    const i32                       guess
+) {
+    // Shallow scores make poor guesses.
+    if (depth < ASPIRATION_MIN_DEPTH)
+        return search_root(game, moves, scores, depth, -SCORE_INF, SCORE_INF);
+
+    i32 lowDelta    = ASPIRATION_DELTA;
+    i32 highDelta   = ASPIRATION_DELTA;
+    while (true) {
+        // Open a side fully once it has widened too far.
+        const i32 alpha = lowDelta > ASPIRATION_MAX_DELTA ? -SCORE_INF : guess - lowDelta;
+        const i32 beta  = highDelta > ASPIRATION_MAX_DELTA ? SCORE_INF : guess + highDelta;
+
+        const auto [best, score] = search_root(game, moves, scores, depth, alpha, beta);
+        if (stopped())
+            return std::tuple(0, 0);
+
+        // Widen whichever side the score fell out of and search again.
+        if (score <= alpha)
+            lowDelta *= 2;
+        else if (score >= beta)
+            highDelta *= 2;
+        else
+            return std::tuple(best, score);
+    }
+}
+
+std::tuple<size, i32> Search::search_mtdf(
+    const Game                      game,
+    MoveList&                       moves,
+    std::array<i32, N_PITS>&        scores,
+    const i32                       depth,
+    const i32                       guess
+) {
+    i32     lower   = -SCORE_INF;
+    i32     upper   = SCORE_INF;
+    i32     score   = guess;
+    size    best    = 0;
+    Line    bestPv  = {};
+
+    while (lower < upper) {
+        // Test whether the score is at least `beta`, never retesting a known bound.
+        const i32 beta = score == lower ? score + 1 : score;
+
+        const auto [iterBest, iterScore] = search_root(game, moves, scores, depth, beta - 1, beta);
+        if (stopped())
+            return std::tuple(0, 0);
+
+        score = iterScore;
+        if (score < beta)
+            upper = score;
+        else {
+            lower   = score;
+            best    = iterBest;
+            bestPv  = pv[0];
+        }
+    }
+
+    pv[0] = bestPv;
+    return std::tuple(best, score);
+}
+
+std::tuple<size, i32> Search::search_root(
+    const Game                      game,
+    MoveList&                       moves,
+    std::array<i32, N_PITS>&        scores,
+    const i32                       depth,
+    i32                             alpha,
+    const i32                       beta
+) {
+    const size              nMoves      = moves.n_moves();
+    const i32               origAlpha   = alpha;
+    std::array<Line, N_PITS> lines      = {};
+    size                    nSearched   = nMoves;
+
+    // The root is always on the last iteration's principal variation.
+    followPv = true;
+
+    if (shared.pool != nullptr && depth > SPLIT_MIN_DEPTH && nMoves > 1) {
+        // Search the eldest brother first, then the rest in parallel.
+        scores[0] = search_move_split(game, moves[0], depth - 1, 1, alpha, beta, nullptr);
+        followPv = false;
+        if (stopped())
+            return std::tuple(0, 0);
+        if (scores[0] > alpha) {
+            alpha = scores[0];
+            lines[0].set(moves[0], pv[1]);
+        }
+
+        // When deterministic, siblings keep the eldest's window so whether they
+        // beat it doesn't depend on which siblings finished first.
+        if (alpha < beta) {
+            SplitPoint sp(nullptr, alpha, beta, scores[0], moves[0], shared.deterministic, nMoves - 1);
+            for (size i = 1; i < nMoves; i++)
+                shared.pool->push(id, [this, game, &moves, &scores, &lines, &sp, depth, i](const size worker){
+                    (*shared.searches)[worker].search_sibling(game, moves[i], depth - 1, 1, sp, &scores[i], &lines[i]);
+                });
+            wait_for(sp);
+        } else
+            nSearched = 1;
+    } else {
+        // Iterate possible moves.
+        for (size i = 0; i < nMoves; i++) {
+            i32 score = 0;
+            if (i == 0)
+                score = search_move(game, moves[i], depth - 1, 1, alpha, beta);
+            else {
+                score = search_move(game, moves[i], depth - 1, 1, alpha, alpha + 1);
+                if (score > alpha && score < beta && !stopped())
+                    score = search_move(game, moves[i], depth - 1, 1, alpha, beta);
+            }
+            followPv = false;
+            if (stopped())
+                break;
+
+            scores[i] = score;
+            if (score > alpha) {
+                alpha = score;
+                lines[i].set(moves[i], pv[1]);
+            }
+
+            // The rest can't change a score that's already too high.
+            if (alpha >= beta) {
+                nSearched = i + 1;
+                break;
+            }
+        }
+    }
+
+    if (stopped())
+        return std::tuple(0, 0);
+
+    // Pick the best move, preferring exact scores (those with a line) to
+    // bounds that tie them, then the earliest.
+    size best = 0;
+    for (size i = 1; i < nSearched; i++) {
+        const bool isExact = lines[i].length > 0;
+        if (scores[i] > scores[best] || (scores[i] == scores[best] && isExact && lines[best].length == 0))
+            best = i;
+    }
+    pv[0] = lines[best];
+
+    // Only a score within the window is exact.
+    const TTable::Bound bound = scores[best] <= origAlpha
+        ? TTable::Bound::UPPER
+        : scores[best] >= beta
+            ? TTable::Bound::LOWER
+            : TTable::Bound::EXACT;
+    store_table(game.hash(), depth, scores[best], bound, moves[best], 0);
+
+    return std::tuple(best, scores[best]);
+}
+
+void Search::order_root_moves(const Game, MoveList& moves, std::array<i32, N_PITS>& scores, const size best) const {
+    const size                      nMoves      = moves.n_moves();
+    std::array<ScoredMove, N_PITS>  scoredMoves = {};
+
+    // Scores are already from the side to move's perspective.
+    for (size i = 0; i < nMoves; i++)
+        scoredMoves[i] = ScoredMove(i, scores[i]);
+
+    // Only the best move's score is exact when deterministic.
+    if (shared.deterministic)
+        for (size i = 0; i < nMoves; i++)
+            scoredMoves[i].score = 0;
+
+    // The best move goes first even if a narrow window left its score tied.
+    scoredMoves[best].score = SCORE_INF;
+
+    // Keep the previous order between equal scores.
+    std::span<ScoredMove> movesToSort(scoredMoves.begin(), nMoves);
+    std::stable_sort(
+        movesToSort.begin(),
+        movesToSort.end(),
+        [](auto a, auto b){ return a.score > b.score; }
+    );
+
+    // Write back the new order.
+    MoveList                        oldMoves    = moves;
+    const std::array<i32, N_PITS>   oldScores   = scores;
+    for (size i = 0; i < nMoves; i++) {
+        moves[i]    = oldMoves[scoredMoves[i].i];
+        scores[i]   = oldScores[scoredMoves[i].i];
+    }
+}
+
+void Search::check_limits() {
+    // Share this thread's progress.
+    const u64   allNodes    = shared.nodes.fetch_add(nodes - nodesShared, std::memory_order_relaxed) + nodes - nodesShared;
+    const auto& limits      = shared.limits;
+    nodesShared = nodes;
+    share_stats();
+
+    // Only the main thread stops the search, and only after finishing the
+    // first iteration so there is always a move to play.
+    if (id == 0 && canStop) {
+        if (limits.nodes > 0 && allNodes >= limits.nodes)
+            shared.stop.store(true, std::memory_order_relaxed);
+        if (limits.movetime > 0 && elapsed_ms(shared.startTime) >= static_cast<f64>(limits.movetime))
+            shared.stop.store(true, std::memory_order_relaxed);
+        if (shared.halt != nullptr && shared.halt->load(std::memory_order_relaxed))
+            shared.stop.store(true, std::memory_order_relaxed);
+    }
+
+    // Check again after another batch of nodes or at the node limit.
+    nextCheck = nodes + CHECK_INTERVAL;
+    if (limits.nodes > allNodes)
+        nextCheck = std::min(nextCheck, nodes + limits.nodes - allNodes);
+}
+
+void Search::share_stats() {
+    if constexpr (STATS) {
+        std::lock_guard lock(shared.statsMutex);
+        shared.stats.add(stats);
+        stats = {};
+    }
+}
+
+Search::Result Search::progress(const Result& result, const Clock::time_point iterStart) {
+    Result info = result;
+    share_nodes();
+
+    info.nodes      = shared.nodes.load(std::memory_order_relaxed);
+    info.tbProbes   = shared.tbProbes.load(std::memory_order_relaxed);
+    info.tbHits     = shared.tbHits.load(std::memory_order_relaxed);
+    info.time       = static_cast<u64>(elapsed_ms(shared.startTime));
+    info.iterTime   = static_cast<u64>(elapsed_ms(iterStart));
+    if constexpr (STATS) {
+        std::lock_guard lock(shared.statsMutex);
+        info.stats = shared.stats;
+    }
+
+    return info;
+}
+
+f64 Search::elapsed_ms(const Clock::time_point since) {
+    return std::chrono::duration<f64, std::milli>(Clock::now() - since).count();
+}
+
+__attribute__((hot))
+MoveList Search::get_sorted_moves(const Game game, const u8 ttMove, const u8 pvMove, const i32 ply) const {
+    MoveList                        legalMoves  = game.legal_moves();
+    const size                      nMoves      = legalMoves.n_moves();
+    std::array<ScoredMove, N_PITS>  scoredMoves = {};
+    const auto                      [u, o]      = game.get_turn_user_opp();
+    const bool                      isPovTurn   = game.is_pov_turn();
+
+    // Score legal moves.
+    for (size i = 0; i < nMoves; i++) {
+        const i32 score = legalMoves[i] == pvMove
+            ? PV_MOVE_SCORE
+            : legalMoves[i] == ttMove
+                ? TT_MOVE_SCORE
+                : score_move(u, o, legalMoves[i], ply, isPovTurn);
+        scoredMoves[i] = ScoredMove(i, score);
+    }
+
+    // Sort moves based on score.
+    std::span<ScoredMove> movesToSort(scoredMoves.begin(), nMoves);
+    std::sort(
+        movesToSort.begin(),
+        movesToSort.end(),
+        [](auto a, auto b){ return a.score > b.score; }
+    );
+    
+    // Get final sorted move list.
+    MoveList orderedMoves(nMoves);
+    for (size i = 0; i < nMoves; i++)
+        orderedMoves[i] = legalMoves[scoredMoves[i].i];
+
+    return orderedMoves;
+}
+
+u8 Search::next_pv_move(const i32 ply) {
+    // Leaving the principal variation anywhere leaves it for the whole subtree.
+    if (followPv && static_cast<size>(ply) < prevPv.length)
+        return prevPv.moves[ply];
+
+    followPv = false;
+    return 0;
+}
+
+__attribute__((hot))
+i32 Search::search_move(Game game, const u8 move, const i32 depth, const i32 ply, const i32 a, const i32 b) {
+    const bool isPovTurn = game.is_pov_turn();
+    lastMoves[ply] = move_index(isPovTurn, move);
+
+    // This is OK because only legal moves are iterated.
+    game.make_move_unchecked(move);
+
+    return search_child(game, isPovTurn, depth, ply, a, b);
+}
+
+__attribute__((hot))
+i32 Search::search_child(const Game child, const bool isPovTurn, const i32 depth, const i32 ply, const i32 a, const i32 b) {
+    // A chain keeps the turn, and with it the perspective.
+    if (child.is_pov_turn() == isPovTurn)
+        return negamax(child, depth, ply, a, b);
+    else
+        return -negamax(child, depth, ply, -b, -a);
+}
+
+__attribute__((hot))
+i32 Search::search_frontier(const Game& game, MoveList& moves, const i32 ply, i32 a, const i32 b) {
+    const bool                  isPovTurn   = game.is_pov_turn();
+    const size                  nMoves      = moves.n_moves();
+    std::array<Game, N_PITS>    children;
+    BatchEval::Batch            batch       = {};
+    BatchEval::Scores           evals;
+    i32                         score       = -SCORE_INF;
+    for (size i = 0; i < nMoves; i++) {
+        // Most nodes that cut off do so on their first move, so search it
+        // alone before making the rest and evaluating them together.
+        if (i == 1) {
+            for (size j = 1; j < nMoves; j++) {
+                // This is OK because only legal moves are iterated.
+                children[j] = game;
+                children[j].make_move_unchecked(moves[j]);
+
+                const auto [ca, cb] = children[j].get_sides();
+                batch.a[j - 1] = ca.bits();
+                batch.b[j - 1] = cb.bits();
+            }
+            batch.n = nMoves - 1;
+            BatchEval::evaluate(batch, isPovTurn, ply + 1, evals);
+        }
+
+        // The rest settle their tactics from their evaluation, proven no
+        // better than the first with a null window. Without quiescence, the
+        // evaluation is the score.
+        i32 moveScore = 0;
+        if (i == 0)
+            moveScore = search_move(game, moves[i], 0, ply + 1, a, b);
+        else {
+            lastMoves[ply + 1] = move_index(isPovTurn, moves[i]);
+            if (!shared.quiescence)
+                moveScore = count_leaf(evals[i - 1], ply + 1);
+            else {
+                moveScore = quiesce_child(Position(children[i]), isPovTurn, evals[i - 1], ply + 1, a, a + 1);
+                if (moveScore > a && moveScore < b && !stopped())
+                    moveScore = quiesce_child(Position(children[i]), isPovTurn, evals[i - 1], ply + 1, a, b);
+            }
+        }
+        followPv = false;
+        if (stopped())
+            return 0;
+
+        score = std::max(score, moveScore);
+        if (score > a) {
+            a = score;
+            pv[ply].set(moves[i], pv[ply + 1]);
+        }
+        if (a >= b) {
+            count_cutoff(i);
+            update_ordering(moves[i], std::span(moves.begin(), i), 1, ply, isPovTurn);
+            break;
+        }
+    }
+
+    return score;
+}
+
+__attribute__((hot))
+bool Search::next_chain(ChainList& chains, const bool isPovTurn, const i32 depth, const i32 ply, const i32 a, const i32 b, Game& child) {
+    size length = 0;
+    while (chains.advance(child, length)) {
+        const i32 linkDepth = depth - static_cast<i32>(length);
+        const i32 linkPly   = ply + static_cast<i32>(length);
+
+        // Play on from a link that keeps the turn, as its node would have.
+        const bool isChain = child.is_pov_turn() == isPovTurn
+            && linkDepth > 0
+            && !child.is_over()
+            && !child.is_decided()
+            && chains.can_push()
+            && !is_solved(child);
+        if (isChain) {
+            // Its node would have stopped at a usable previous search, so end
+            // the chain there to let the search find it.
+            const auto entry = linkDepth >= TT_MIN_DEPTH
+                ? probe_table(child.hash(), linkPly)
+                : std::nullopt;
+            if (entry && is_usable(*entry, linkDepth, a, b)) {
+                if (chains.is_new(child, length))
+                    return true;
+                continue;
+            }
+
+            // Order its moves as its node would have, though only the first
+            // chain can still be on the last principal variation.
+            lastMoves[linkPly] = move_index(isPovTurn, chains.last());
+            auto moves = get_sorted_moves(child, entry ? entry->move : 0, followPv ? next_pv_move(linkPly) : 0, linkPly);
+            chains.push(child, moves);
+            continue;
+        }
+
+        if (chains.is_new(child, length))
+            return true;
+    }
+
+    return false;
+}
+
+__attribute__((hot))
+i32 Search::search_move_split(
+    Game                game,
+    const u8            move,
+    const i32           depth,
+    const i32           ply,
+    const i32           a,
+    const i32           b,
+    const SplitPoint*   sp
+) {
+    const bool isPovTurn = game.is_pov_turn();
+    lastMoves[ply] = move_index(isPovTurn, move);
+
+    // This is OK because only legal moves are iterated.
+    game.make_move_unchecked(move);
+
+    // A chain keeps the turn, and with it the perspective.
+    if (game.is_pov_turn() == isPovTurn)
+        return negamax_split(game, depth, ply, a, b, sp);
+    else
+        return -negamax_split(game, depth, ply, -b, -a, sp);
+}
+
+__attribute__((hot))
+i32 Search::negamax(const Game game, const i32 depth, const i32 ply, i32 a, i32 b) {
+    // Settle pending captures and chains before trusting the evaluation.
+    if (depth < 1 && shared.quiescence)
+        return quiesce(Position(game), ply, a, b);
+
+    // Give up on the search once it's out of time or nodes.
+    if (++nodes >= nextCheck)
+        check_limits();
+    if (stopped())
+        return 0;
+
+    pv[ply].length = 0;
+
+    // Break for depth, game end, or a known result.
+    if (depth < 1 || game.is_over() || game.is_decided() || is_solved(game))
+        return evaluate(game, ply);
+
+    // Cut the window to the results the mancalas still allow.
+    const auto [lower, upper] = result_bounds(game, ply);
+    a = std::max(a, lower);
+    b = std::min(b, upper);
+    if (a >= b)
+        return a;
+
+    // Use a previous search of this position if it was deep enough.
+    const bool  useTable    = depth >= TT_MIN_DEPTH;
+    const u64   key         = useTable ? game.hash() : 0;
+    const auto  entry       = useTable ? probe_table(key, ply) : std::nullopt;
+    if constexpr (STATS) {
+        stats.ttProbes  += useTable;
+        stats.ttHits    += entry.has_value();
+    }
+    if (entry && is_usable(*entry, depth, a, b))
+        return entry->score;
+
+    const i32   origA       = a;
+    const bool  isPovTurn   = game.is_pov_turn();
+    i32         score       = -SCORE_INF;
+    u8          bestMove    = 0;
+    auto        moves       = get_sorted_moves(game, entry ? entry->move : 0, next_pv_move(ply), ply);
+
+    // Every child is at the horizon, where chains aren't played on, so
+    // evaluate them together.
+    static_assert(TT_MIN_DEPTH > 1, "search_frontier doesn't store its results");
+    if (depth == 1 && shared.tablebase == nullptr)
+        return search_frontier(game, moves, ply, a, b);
+
+    ChainList   chains;
+    chains.push(game, moves);
+
+    std::array<u8, MAX_DEPTH>   chainMoves;
+    Game                        child       = game;
+    for (size i = 0; next_chain(chains, isPovTurn, depth, ply, a, b, child); i++) {
+        const i32 length = static_cast<i32>(chains.length());
+        lastMoves[ply + length] = move_index(isPovTurn, chains.last());
+
+        // Prove the rest are no better than the first with a null window.
+        i32 moveScore = 0;
+        if (i == 0)
+            moveScore = search_child(child, isPovTurn, depth - length, ply + length, a, b);
+        else {
+            moveScore = search_child(child, isPovTurn, depth - length, ply + length, a, a + 1);
+            if (moveScore > a && moveScore < b && !stopped())
+                moveScore = search_child(child, isPovTurn, depth - length, ply + length, a, b);
+        }
+        followPv = false;
+        if (stopped())
+            return 0;
+
+        if (moveScore > score) {
+            score       = moveScore;
+            bestMove    = chains.first();
+        }
+        if (score > a) {
+            a = score;
+            chains.moves(chainMoves);
+            pv[ply].set(std::span(chainMoves.data(), static_cast<size>(length)), pv[ply + length]);
+        }
+        if (a >= b) {
+            // Each link cut off its own node in effect, so learn from all,
+            // and bound the links' positions for when they are met again.
+            count_cutoff(chains.tried(0).size());
+            for (size link = 0; link < chains.length(); link++) {
+                const i32 linkDepth = depth - static_cast<i32>(link);
+                const i32 linkPly   = ply + static_cast<i32>(link);
+                update_ordering(chains.move(link), chains.tried(link), linkDepth, linkPly, isPovTurn);
+                if (link > 0 && linkDepth >= TT_MIN_DEPTH)
+                    store_table(chains.game(link).hash(), linkDepth, score, TTable::Bound::LOWER, chains.move(link), linkPly);
+            }
+            break;
+        }
+    }
+
+    // Save the result for transpositions.
+    const TTable::Bound bound = score <= origA
+        ? TTable::Bound::UPPER
+        : score >= b
+            ? TTable::Bound::LOWER
+            : TTable::Bound::EXACT;
+    if (useTable)
+        store_table(key, depth, score, bound, bestMove, ply);
+
+    return score;
+}
+
+__attribute__((hot))
+i32 Search::negamax_split(const Game game, const i32 depth, const i32 ply, i32 a, i32 b, const SplitPoint* parent) {
+    // Small subtrees aren't worth splitting.
+    if (depth < SPLIT_MIN_DEPTH)
+        return negamax(game, depth, ply, a, b);
+
+    // Give up on the search once it's out of time or nodes, or a sibling cut off.
+    if (++nodes >= nextCheck)
+        check_limits();
+    if (stopped() || aborted(parent))
+        return 0;
+
+    pv[ply].length = 0;
+
+    // Break for game end or a known result.
+    if (game.is_over() || game.is_decided() || is_solved(game))
+        return evaluate(game, ply);
+
+    // Cut the window to the results the mancalas still allow.
+    const auto [lower, upper] = result_bounds(game, ply);
+    a = std::max(a, lower);
+    b = std::min(b, upper);
+    if (a >= b)
+        return a;
+
+    // Use a previous search of this position if it was deep enough.
+    const u64   key     = game.hash();
+    const auto  entry   = probe_table(key, ply);
+    if constexpr (STATS) {
+        stats.ttProbes++;
+        stats.ttHits += entry.has_value();
+    }
+    if (entry && is_usable(*entry, depth, a, b))
+        return entry->score;
+
+    const i32   origA       = a;
+    auto        moves       = get_sorted_moves(game, entry ? entry->move : 0, next_pv_move(ply), ply);
+    const size  nMoves      = moves.n_moves();
+
+    // Search the eldest brother serially.
+    i32 score       = search_move_split(game, moves[0], depth - 1, ply + 1, a, b, parent);
+    u8  bestMove    = moves[0];
+    followPv = false;
+    if (stopped() || aborted(parent))
+        return 0;
+
+    if (score > a) {
+        a = score;
+        pv[ply].set(moves[0], pv[ply + 1]);
+    }
+    if (a >= b) {
+        count_cutoff(0);
+        update_ordering(moves[0], {}, depth, ply, game.is_pov_turn());
+    }
+
+    // Then the younger brothers in parallel, unless the eldest already cut off.
+    if (a < b && nMoves > 1) {
+        // Tasks run while waiting can overwrite this ply's line.
+        const Line  eldestPv    = pv[ply];
+        SplitPoint  sp(parent, a, b, score, bestMove, false, nMoves - 1);
+        for (size i = 1; i < nMoves; i++)
+            shared.pool->push(id, [this, game, &moves, &sp, depth, ply, i](const size worker){
+                (*shared.searches)[worker].search_sibling(game, moves[i], depth - 1, ply + 1, sp, nullptr, nullptr);
+            });
+        wait_for(sp);
+
+        if (stopped() || aborted(parent))
+            return 0;
+
+        score       = sp.score;
+        bestMove    = sp.bestMove;
+        pv[ply]     = sp.pv.length > 0 ? sp.pv : eldestPv;
+    }
+
+    // Save the result for transpositions.
+    const TTable::Bound bound = score <= origA
+        ? TTable::Bound::UPPER
+        : score >= b
+            ? TTable::Bound::LOWER
+            : TTable::Bound::EXACT;
+    store_table(key, depth, score, bound, bestMove, ply);
+
+    return score;
+}
+
+__attribute__((hot))
+i32 Search::quiesce_child(const Position child, const bool isPovTurn, const i32 eval, const i32 ply, const i32 a, const i32 b) {
+    // A chain keeps the turn, and with it the perspective.
+    if (child.is_pov_turn() == isPovTurn)
+        return quiesce(child, ply, a, b, eval);
+    else
+        return -quiesce(child, ply, -b, -a, -eval);
+}
+
+__attribute__((hot))
+i32 Search::quiesce(const Position position, const i32 ply, i32 a, const i32 b, const std::optional<i32> eval) {
+    // Give up on the search once it's out of time or nodes.
+    if (++nodes >= nextCheck)
+        check_limits();
+    if (stopped())
+        return 0;
+
+    pv[ply].length = 0;
+
+    // Break for game end, a known result, or running out of plies.
+    if (position.is_over() || position.is_decided() || is_solved(position) || ply >= MAX_DEPTH)
+        return evaluate(position, ply);
+
+    // Standing pat on a quiet move is assumed to be no worse than the evaluation.
+    if constexpr (STATS)
+        stats.evals += eval.has_value();
+    i32 score = eval ? eval.value() : evaluate(position, ply);
+    if (score >= b)
+        return score;
+    a = std::max(a, score);
+
+    const auto                      [u, o]      = position.get_user_opp();
+    const bool                      isPovTurn   = position.is_pov_turn();
+    const i32                       standPat    = score;
+    MoveList                        legalMoves  = position.legal_moves();
+    std::array<ScoredMove, N_PITS>  tactics     = {};
+    size                            nTactics    = 0;
+
+    // Only captures and chains are searched, best first.
+    for (size i = 0; i < legalMoves.n_moves(); i++) {
+        const i32 moveScore = score_tactics(u, o, legalMoves[i]);
+        if (moveScore <= QUIET_MAX_SCORE)
+            continue;
+
+        size j = nTactics++;
+        for (; j > 0 && tactics[j - 1].score < moveScore; j--)
+            tactics[j] = tactics[j - 1];
+        tactics[j] = ScoredMove(i, moveScore);
+    }
+
+    for (size i = 0; i < nTactics; i++) {
+        const u8 move = legalMoves[tactics[i].i];
+
+        Position child = position;
+        child.make_move_unchecked(move);
+
+        // Skip captures that can't reach alpha even gaining every stone they
+        // take, unless they end the game or reach a drawn or decided position.
+        const i32 nCaptured = n_captured(u, o, move);
+        if (nCaptured > 0 && !child.is_over()) {
+            const i32   gain        = (nCaptured + 1) * EW_STONE_IN_MANCALA + (nCaptured - 1) * EW_STONE_IN_PIT;
+            const bool  isDecided   = u.mancala() + nCaptured + 1 >= N_STONES_TO_DRAW
+                || (shared.tablebase != nullptr && shared.tablebase->covers(child.to_game()));
+            if (!isDecided && standPat + gain + DELTA_MARGIN <= a)
+                continue;
+        }
+
+        // A chain keeps the turn, and with it the perspective.
+        lastMoves[ply + 1] = move_index(isPovTurn, move);
+        const i32 moveScore = child.is_pov_turn() == isPovTurn
+            ? quiesce(child, ply + 1, a, b)
+            : -quiesce(child, ply + 1, -b, -a);
+        if (stopped())
+            return 0;
+
+        score = std::max(score, moveScore);
+        if (score > a) {
+            a = score;
+            pv[ply].set(move, pv[ply + 1]);
+        }
+        if (a >= b)
+            break;
+    }
+
+    return score;
+}
+
+void Search::search_sibling(
+    const Game  game,
+    const u8    move,
+    const i32   depth,
+    const i32   ply,
+    SplitPoint& sp,
+    i32*        out,
+    Line*       outPv
+) {
+    // Skip siblings of a node that already cut off.
+    if (!aborted(&sp)) {
+        // Use the tightest window the siblings have found so far.
+        i32 a = 0;
+        i32 b = 0;
+        {
+            std::lock_guard lock(sp.mutex);
+            a = sp.a;
+            b = sp.b;
+        }
+
+        // Prove the sibling is no better with a null window first.
+        i32 score = search_move_split(game, move, depth, ply, a, a + 1, &sp);
+        if (score > a && score < b && !stopped() && !aborted(&sp))
+            score = search_move_split(game, move, depth, ply, a, b, &sp);
+
+        // Merge the result unless it was cut short.
+        if (!stopped() && !aborted(&sp)) {
+            std::lock_guard lock(sp.mutex);
+            if (out != nullptr)
+                *out = score;
+            if (outPv != nullptr && score > a)
+                outPv->set(move, pv[ply]);
+
+            if (score > sp.score) {
+                sp.score    = score;
+                sp.bestMove = move;
+                if (score > a)
+                    sp.pv.set(move, pv[ply]);
+            }
+            if (!sp.isWindowFixed)
+                sp.a = std::max(sp.a, score);
+
+            if (sp.a >= sp.b)
+                sp.cutoff.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    sp.pending.fetch_sub(1, std::memory_order_release);
+}
+
+void Search::wait_for(const SplitPoint& sp) {
+    // Help with any work, ours or stolen, instead of idling.
+    while (sp.pending.load(std::memory_order_acquire) > 0)
+        if (!shared.pool->run_one(id))
+            std::this_thread::yield();
+}
+
+bool Search::is_solved(const Game& game) {
+    if (shared.tablebase == nullptr)
+        return false;
+
+    tbProbes++;
+    if (!shared.tablebase->covers(game))
+        return false;
+
+    tbHits++;
+    return true;
+}
+
+bool Search::is_solved(const Position& position) {
+    return shared.tablebase != nullptr && is_solved(position.to_game());
+}
+
+i32 Search::evaluate(const Game& game, const i32 ply) {
+    if constexpr (STATS)
+        stats.evals++;
+
+    const i32 eval  = game.eval(shared.tablebase);
+    const i32 score = game.is_pov_turn() ? eval : -eval;
+    if (score == EW_WINNING)
+        return EW_WINNING - ply;
+    if (score == -EW_WINNING)
+        return -EW_WINNING + ply;
+
+    return score;
+}
+
+i32 Search::evaluate(const Position& position, const i32 ply) {
+    // Only the tablebase needs the game the position is.
+    if (shared.tablebase != nullptr)
+        return evaluate(position.to_game(), ply);
+
+    if constexpr (STATS)
+        stats.evals++;
+
+    const i32 score = position.eval();
+    if (score == EW_WINNING)
+        return EW_WINNING - ply;
+    if (score == -EW_WINNING)
+        return -EW_WINNING + ply;
+
+    return score;
+}
+
+i32 Search::count_leaf(const i32 score, const i32 ply) {
+    if (++nodes >= nextCheck)
+        check_limits();
+    if constexpr (STATS)
+        stats.evals++;
+
+    pv[ply].length = 0;
+    return score;
+}
+
+std::tuple<i32, i32> Search::result_bounds(const Game& game, const i32 ply) {
+    // Nothing is decided before the next move.
+    const auto [lower, upper] = game.bounds();
+    const auto at_next_ply = [ply](const i32 bound){
+        return bound == EW_WINNING
+            ? EW_WINNING - ply - 1
+            : bound == -EW_WINNING
+                ? -EW_WINNING + ply + 1
+                : bound;
+    };
+
+    return game.is_pov_turn()
+        ? std::tuple(at_next_ply(lower), at_next_ply(upper))
+        : std::tuple(-at_next_ply(upper), -at_next_ply(lower));
+}
+
+std::optional<TTable::Entry> Search::probe_table(const u64 key, const i32 ply) const {
+    auto entry = shared.table.probe(key);
+    if (entry && is_decided(entry->score))
+        entry->score += entry->score > 0 ? -ply : ply;
+
+    return entry;
+}
+
+void Search::store_table(const u64 key, const i32 depth, const i32 score, const TTable::Bound bound, const u8 move, const i32 ply) {
+    const i32 tableScore = is_decided(score)
+        ? score + (score > 0 ? ply : -ply)
+        : score;
+    shared.table.store(key, depth, tableScore, bound, move);
+}
+
+bool Search::is_usable(const TTable::Entry& entry, const i32 depth, const i32 a, const i32 b) const {
+    // Deeper results would make the score depend on what's in the table.
+    if (shared.deterministic ? entry.depth != depth : entry.depth < depth)
+        return false;
+
+    return entry.bound == TTable::Bound::EXACT
+        || (entry.bound == TTable::Bound::LOWER && entry.score >= b)
+        || (entry.bound == TTable::Bound::UPPER && entry.score <= a);
+}
+
+__attribute__((hot))
+i32 Search::score_move(const Side u, const Side o, const u8 move, const i32 ply, const bool isPovTurn) const {
+    // What a move learned from cutoffs elsewhere stays below a pit step, so it
+    // only breaks ties between moves that look the same on the board.
+    i32 learned = 0;
+    for (size i = 0; i < N_KILLERS; i++)
+        if (killers[ply][isPovTurn][i] == move)
+            learned = std::max(learned, KILLER_SCORES[i]);
+    if (ply > 0 && counterMoves[lastMoves[ply]] == move)
+        learned = std::max(learned, COUNTER_SCORE);
+
+    return score_tactics(u, o, move) + learned + history[isPovTurn][move];
+}
+
+__attribute__((hot))
+i32 Search::score_tactics(const Side u, const Side o, const u8 i) {
+    // Captures are best to try first.
+    if (const i32 nCaptured = n_captured(u, o, i); nCaptured > 0)
+        return CAPTURE_SCORE + nCaptured * PIT_SCORE;
+
+    // Chains are good; prioritize ones closer to the mancala.
+    if (u.pit(i) == i)
+        return CHAIN_SCORE - i * PIT_SCORE;
+
+    // Nothing significant about the move; closer to the mancala is still better.
+    return static_cast<i32>(N_PITS + 1 - i) * PIT_SCORE;
+}
+
+__attribute__((hot))
+i32 Search::n_captured(const Side u, const Side o, const u8 i) {
+    // The last stone must land in an empty pit on the mover's side.
+    const u8 nStones = static_cast<u8>(u.pit(i));
+    if (nStones == 0 || nStones >= i || u.pit(i - nStones) != 0)
+        return 0;
+
+    return o.pit(7 + nStones - i);
+}
+
+void Search::update_ordering(const u8 move, const std::span<const u8> tried, const i32 depth, const i32 ply, const bool isPovTurn) {
+    // Keep the most recent killers, without duplicates.
+    auto& plyKillers = killers[ply][isPovTurn];
+    if (plyKillers[0] != move) {
+        for (size k = N_KILLERS - 1; k > 0; k--)
+            plyKillers[k] = plyKillers[k - 1];
+        plyKillers[0] = move;
+    }
+
+    if (ply > 0)
+        counterMoves[lastMoves[ply]] = move;
+
+    // Reward the move and penalize those that failed to cut off before it,
+    // halving everything before the scores leave their band.
+    auto&       moveHistory = history[isPovTurn];
+    moveHistory[move] += depth;
+    for (const u8 triedMove: tried)
+        if (triedMove != move)
+            moveHistory[triedMove] -= depth;
+
+    const auto is_out_of_band = [](const i32 score){ return std::abs(score) > HISTORY_MAX; };
+    while (std::ranges::any_of(moveHistory, is_out_of_band))
+        for (auto& score: moveHistory)
+            score /= 2;
+}
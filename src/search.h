@@ -0,0 +1,925 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "chainlist.h"
+#include "config.h"
+#include "def.h"
+#include "game.h"
+#include "movelist.h"
+#include "position.h"
+#include "side.h"
+#include "tablebase.h"
+#include "threadpool.h"
+#include "ttable.h"
+
+class Search {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Is `true` if the search counts statistics (built with `ROCKHOP_STATS`).
+     *
+     * @details When `false`, the counting compiles away entirely.
+     */
+#ifdef ROCKHOP_STATS
+    static constexpr inline bool STATS = true;
+#else
+    static constexpr inline bool STATS = false;
+#endif
+
+    /**
+     * @brief The deepest iteration a search will start.
+     */
+    static constexpr inline i32 MAX_DEPTH = 64;
+
+    /**
+     * @brief A line of moves, such as a principal variation.
+     */
+    struct Line {
+        /**
+         * @brief The moves, in the order played.
+         */
+        std::array<u8, MAX_DEPTH> moves;
+
+        /**
+         * @brief The number of moves in the line.
+         */
+        size length;
+
+        /**
+         * @brief Sets the line to the given move followed by the given line.
+         */
+        void set(u8 move, const Line& rest);
+
+        /**
+         * @brief Sets the line to the given moves followed by the given line.
+         */
+        void set(std::span<const u8> first, const Line& rest);
+    };
+
+    struct Limits {
+        /**
+         * @brief The maximum depth to search to.
+         */
+        i32 depth;
+
+        /**
+         * @brief The time budget in milliseconds, or 0 for no limit.
+         */
+        u64 movetime;
+
+        /**
+         * @brief The node budget, or 0 for no limit.
+         */
+        u64 nodes;
+    };
+
+    /**
+     * @brief How each iteration searches the root.
+     */
+    enum class Driver {
+        /**
+         * @brief One search with a window of every possible score.
+         */
+        FULL_WINDOW,
+
+        /**
+         * @brief A narrow window around the last iteration's score, widened
+         * and searched again while the score falls outside it.
+         */
+        ASPIRATION,
+
+        /**
+         * @brief Null-window searches only, moving the window toward the
+         * score until its bounds meet (MTD(f)).
+         */
+        MTDF,
+    };
+
+    /**
+     * @brief Statistics counted while searching, if `STATS` is set.
+     */
+    struct Stats {
+        /**
+         * @brief The number of leaf evaluations.
+         */
+        u64 evals;
+
+        /**
+         * @brief The number of transposition table lookups.
+         */
+        u64 ttProbes;
+
+        /**
+         * @brief The number of transposition table lookups that found the position.
+         */
+        u64 ttHits;
+
+        /**
+         * @brief The number of beta cutoffs in serially searched nodes, indexed
+         * by the cutoff move's place in the ordered move list.
+         */
+        std::array<u64, N_PITS> cutoffs;
+
+        /**
+         * @brief Adds the other statistics to these.
+         */
+        void add(const Stats& other);
+
+        /**
+         * @brief Returns the total number of beta cutoffs.
+         */
+        u64 n_cutoffs() const;
+    };
+
+    struct Result {
+        /**
+         * @brief The best move of the last completed iteration.
+         */
+        u64 move;
+
+        /**
+         * @brief The evaluation of the last completed iteration.
+         */
+        i32 score;
+
+        /**
+         * @brief The principal variation of the last completed iteration.
+         */
+        Line pv;
+
+        /**
+         * @brief The depth of the last completed iteration.
+         */
+        i32 depth;
+
+        /**
+         * @brief The number of nodes searched.
+         */
+        u64 nodes;
+
+        /**
+         * @brief The time spent searching in milliseconds.
+         */
+        u64 time;
+
+        /**
+         * @brief The time spent on the last completed iteration in milliseconds.
+         */
+        u64 iterTime;
+
+        /**
+         * @brief The number of positions looked up in the tablebase.
+         */
+        u64 tbProbes;
+
+        /**
+         * @brief The number of tablebase lookups that found the position.
+         */
+        u64 tbHits;
+
+        /**
+         * @brief The search statistics, all zero unless `STATS` is set.
+         */
+        Stats stats;
+
+        /**
+         * @brief Is `true` if the position was solved to the end of the game,
+         * making the result exact rather than an evaluation.
+         */
+        bool isExact;
+
+        /**
+         * @brief The final stone difference (PoV minus upper) under perfect
+         * play, if `isExact`.
+         */
+        i32 stoneDiff;
+
+        /**
+         * @brief Returns `score` from the perspective of the side to move in
+         * the searched position, given whether it's the PoV side.
+         *
+         * @details Front ends give scores this way, matching the moves, which
+         * are always the side to move's.
+         */
+        inline i32 mover_score(const bool isPovTurn) const {
+            return isPovTurn ? score : -score;
+        }
+    };
+
+    /**
+     * @brief Called by the main thread with the progress after each completed iteration.
+     */
+    using Reporter = std::function<void(const Result&)>;
+
+    /**
+     * @brief State shared by every thread searching the same position.
+     */
+    struct Shared {
+        /**
+         * @brief The transposition table.
+         */
+        TTable& table;
+
+        /**
+         * @brief The limits of the search.
+         */
+        Limits limits;
+
+        /**
+         * @brief When the search started.
+         */
+        Clock::time_point startTime;
+
+        /**
+         * @brief Set to stop every thread.
+         */
+        std::atomic<bool> stop;
+
+        /**
+         * @brief Set from outside the search to stop it once an iteration has
+         * completed, or `nullptr` if it can't be stopped that way.
+         */
+        const std::atomic<bool>* halt;
+
+        /**
+         * @brief The number of nodes searched by all threads.
+         */
+        std::atomic<u64> nodes;
+
+        /**
+         * @brief The number of tablebase lookups by all threads.
+         */
+        std::atomic<u64> tbProbes;
+
+        /**
+         * @brief The number of tablebase lookups by all threads that found the position.
+         */
+        std::atomic<u64> tbHits;
+
+        /**
+         * @brief Guards `stats`.
+         */
+        std::mutex statsMutex;
+
+        /**
+         * @brief The statistics shared by all threads.
+         */
+        Stats stats;
+
+        /**
+         * @brief Called after each completed iteration, if set.
+         */
+        Reporter report;
+
+        /**
+         * @brief The pool to split nodes across (YBWC), or `nullptr` to search
+         * each thread's tree on its own (Lazy SMP).
+         */
+        ThreadPool* pool;
+
+        /**
+         * @brief The searches of the pool's workers, indexed by worker.
+         */
+        std::vector<Search>* searches;
+
+        /**
+         * @brief The endgame tablebase, or `nullptr` if none is loaded.
+         */
+        const Tablebase* tablebase;
+
+        /**
+         * @brief How each iteration searches the root.
+         */
+        Driver driver;
+
+        /**
+         * @brief Is `true` if the horizon is extended by captures and chains
+         * before evaluating.
+         */
+        bool quiescence;
+
+        /**
+         * @brief Is `true` if the result must not depend on timing or the
+         * table's contents, so only entries of the exact depth are trusted.
+         */
+        bool deterministic;
+
+        explicit Shared(TTable& table, const Limits& limits);
+    };
+
+private:
+    struct ScoredMove {
+        /**
+         * @brief The move's index in a `MoveList`.
+         */
+        size i;
+
+        /**
+         * @brief The move's score.
+         */
+        i32 score;
+
+        constexpr ScoredMove() : i(), score() {
+
+        }
+
+        explicit ScoredMove(size i, i32 score);
+    };
+
+    /**
+     * @brief A node whose younger siblings are being searched in parallel.
+     */
+    struct SplitPoint {
+        /**
+         * @brief The split point above this one, or `nullptr` at the top.
+         */
+        const SplitPoint* parent;
+
+        /**
+         * @brief Guards the bounds and best score.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief The node's alpha.
+         */
+        i32 a;
+
+        /**
+         * @brief The node's beta.
+         */
+        i32 b;
+
+        /**
+         * @brief The best score found so far.
+         */
+        i32 score;
+
+        /**
+         * @brief The move with the best score.
+         */
+        u8 bestMove;
+
+        /**
+         * @brief The principal variation from the node, if a sibling found one.
+         */
+        Line pv;
+
+        /**
+         * @brief Is `true` if the siblings keep the window the split point was
+         * made with, so their scores don't depend on the order they finish in.
+         */
+        bool isWindowFixed;
+
+        /**
+         * @brief Set when a sibling caused a cutoff, stopping the others.
+         */
+        std::atomic<bool> cutoff;
+
+        /**
+         * @brief The number of siblings still being searched.
+         */
+        std::atomic<size> pending;
+
+        explicit SplitPoint(
+            const SplitPoint* parent,
+            i32 a,
+            i32 b,
+            i32 score,
+            u8 bestMove,
+            bool isWindowFixed,
+            size pending
+        );
+    };
+
+    /**
+     * @brief The minimum remaining depth to split a node at.
+     *
+     * @details Shallower subtrees are cheaper to search than to hand off.
+     */
+    static constexpr inline i32 SPLIT_MIN_DEPTH = 6;
+
+    /**
+     * @brief The move ordering score of the transposition table's best move.
+     */
+    static constexpr inline i32 TT_MOVE_SCORE = 1'000'000;
+
+    /**
+     * @brief The move ordering score of the last iteration's principal variation move.
+     */
+    static constexpr inline i32 PV_MOVE_SCORE = 2'000'000;
+
+    /**
+     * @brief The gap between the move ordering scores of neighbouring pits.
+     */
+    static constexpr inline i32 PIT_SCORE = 1'000;
+
+    /**
+     * @brief The move ordering score of a capture, plus a pit step per stone captured.
+     */
+    static constexpr inline i32 CAPTURE_SCORE = 500'000;
+
+    /**
+     * @brief The move ordering score of a chain, minus a pit step per pit number.
+     */
+    static constexpr inline i32 CHAIN_SCORE = 100'000;
+
+    /**
+     * @brief The number of killer moves kept per ply.
+     */
+    static constexpr inline size N_KILLERS = 2;
+
+    /**
+     * @brief The move ordering bonuses of each ply's killer moves, most recent first.
+     */
+    static constexpr inline std::array<i32, N_KILLERS> KILLER_SCORES = { 400, 300 };
+
+    /**
+     * @brief The move ordering bonus of the move that last refuted the previous move.
+     */
+    static constexpr inline i32 COUNTER_SCORE = 300;
+
+    /**
+     * @brief The largest magnitude of a history score before they are all halved.
+     *
+     * @details With the killer bonus, kept within a pit step so the learned
+     * scores never override what a move does on the board.
+     */
+    static constexpr inline i32 HISTORY_MAX = 200;
+
+    /**
+     * @brief The lowest magnitude of a win or loss, those further from the
+     * root scoring closer to it.
+     */
+    static constexpr inline i32 DECIDED_SCORE = EW_WINNING - MAX_DEPTH;
+
+    /**
+     * @brief The shallowest iteration to search with an aspiration window.
+     *
+     * @details Scores of shallower iterations swing too much to guess from.
+     */
+    static constexpr inline i32 ASPIRATION_MIN_DEPTH = 4;
+
+    /**
+     * @brief How far an aspiration window first reaches on each side of the guess.
+     */
+    static constexpr inline i32 ASPIRATION_DELTA = EW_STONE_IN_MANCALA;
+
+    /**
+     * @brief How far an aspiration window can widen before that side is opened fully.
+     */
+    static constexpr inline i32 ASPIRATION_MAX_DELTA = EW_STONE_IN_MANCALA * 16;
+
+    /**
+     * @brief The highest ordering score `score_tactics` gives a move that is
+     * neither a capture nor a chain.
+     */
+    static constexpr inline i32 QUIET_MAX_SCORE = N_PITS * PIT_SCORE;
+
+    /**
+     * @brief How much a capture's evaluation gain may be underestimated by
+     * before delta pruning skips it.
+     */
+    static constexpr inline i32 DELTA_MARGIN = EW_STONE_IN_MANCALA;
+
+    /**
+     * @brief The minimum remaining depth to use the transposition table at.
+     *
+     * @details Nodes closer to the leaves are cheaper to search than to look up.
+     */
+    static constexpr inline i32 TT_MIN_DEPTH = 6;
+
+    /**
+     * @brief The number of nodes between checks of the search limits.
+     */
+    static constexpr inline u64 CHECK_INTERVAL = 1024;
+
+    /**
+     * @brief The largest effective branching factor used to predict iteration costs.
+     */
+    static constexpr inline f64 MAX_EBF = 8.0;
+
+    /**
+     * @brief The state shared with the other threads.
+     */
+    Shared& shared;
+
+    /**
+     * @brief The thread's index; 0 is the main thread, which enforces the limits.
+     */
+    size id;
+
+    /**
+     * @brief The number of nodes this thread has searched.
+     */
+    u64 nodes;
+
+    /**
+     * @brief The number of nodes already added to the shared count.
+     */
+    u64 nodesShared;
+
+    /**
+     * @brief The number of tablebase lookups not yet added to the shared count.
+     */
+    u64 tbProbes;
+
+    /**
+     * @brief The number of tablebase hits not yet added to the shared count.
+     */
+    u64 tbHits;
+
+    /**
+     * @brief The statistics not yet added to the shared statistics.
+     */
+    Stats stats;
+
+    /**
+     * @brief The principal variation from each ply, filled in as the search
+     * returns; `pv[ply]` only holds moves from `ply` on, making it triangular.
+     */
+    std::array<Line, MAX_DEPTH + 1> pv;
+
+    /**
+     * @brief The principal variation of the last completed iteration.
+     */
+    Line prevPv;
+
+    /**
+     * @brief Is `true` while the search is still on the last iteration's
+     * principal variation, so its moves are tried first.
+     */
+    bool followPv;
+
+    /**
+     * @brief The quiet moves that last caused a cutoff at each ply, most recent first.
+     */
+    std::array<std::array<std::array<u8, N_KILLERS>, 2>, MAX_DEPTH + 1> killers;
+
+    /**
+     * @brief How often each move caused a cutoff, weighted by depth, indexed
+     * by whether the PoV side moved and then by pit.
+     */
+    std::array<std::array<i32, N_PITS + 1>, 2> history;
+
+    /**
+     * @brief The move that last refuted each move, indexed by `move_index`.
+     */
+    std::array<u8, N_PITS * 2 + 1> counterMoves;
+
+    /**
+     * @brief The `move_index` of the move that led to each ply, 0 at the root.
+     */
+    std::array<u8, MAX_DEPTH + 1> lastMoves;
+
+    /**
+     * @brief The node count at which to next check the search limits.
+     */
+    u64 nextCheck;
+
+    /**
+     * @brief Is `true` once an iteration has completed and the search may be stopped.
+     */
+    bool canStop;
+
+public:
+    explicit Search(Shared& shared, size id);
+
+    /**
+     * @brief Searches with iterative deepening until the limits or a stop and
+     * returns the result of the last completed iteration.
+     *
+     * @details With Lazy SMP, helper threads (any but the main thread) start one
+     * ply deeper on odd indices so the threads fill the table with different
+     * depths. With YBWC, only the main thread calls this and nodes are split
+     * across the pool.
+     */
+    Result run(Game game);
+
+    /**
+     * @brief Adds this search's uncounted nodes, tablebase lookups, and
+     * statistics to the shared counts.
+     */
+    void share_nodes();
+
+private:
+    /**
+     * @brief Returns `true` if the search has been stopped.
+     */
+    inline bool stopped() const {
+        return shared.stop.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns `true` if the given split point or any above it was cut off.
+     */
+    static bool aborted(const SplitPoint* sp);
+
+    /**
+     * @brief Searches the root to the given depth with the shared driver and
+     * returns the index of the best move and its evaluation for the side to
+     * move, writing the principal variation to `pv[0]`.
+     *
+     * @details `guess` is the last iteration's score, used by the drivers that
+     * narrow the window. The result is meaningless if the search was stopped.
+     */
+    std::tuple<size, i32> search_iteration(Game game, MoveList& moves, std::array<i32, N_PITS>& scores, i32 depth, i32 guess);
+
+    /**
+     * @brief Searches with aspiration windows around the guess, widening the
+     * side the score falls out of until it lands inside.
+     */
+    std::tuple<size, i32> search_aspiration(Game game, MoveList& moves, std::array<i32, N_PITS>& scores, i32 depth, i32 guess);
+
+    /**
+     * @brief Searches with null windows only, starting at the guess, until the
+     * score's lower and upper bounds meet (MTD(f)).
+     *
+     * @details The best move and principal variation are those of the last
+     * search to fail high, since a search failing low proves nothing about moves.
+     */
+    std::tuple<size, i32> search_mtdf(Game game, MoveList& moves, std::array<i32, N_PITS>& scores, i32 depth, i32 guess);
+
+    /**
+     * @brief Searches each root move to the given depth within the given window
+     * and returns the index of the best move and its evaluation for the side to
+     * move, writing the principal variation to `pv[0]`.
+     *
+     * @details Each move's score is written to `scores`. The first move is
+     * searched with the window and the rest with a null window, being searched
+     * again if they turn out better, until one fails high. Scores outside the
+     * window are only bounds. The result is meaningless if the search was
+     * stopped. Ties go to the earliest move, so the result doesn't depend on
+     * the order parallel siblings finish in.
+     */
+    std::tuple<size, i32> search_root(
+        Game                        game,
+        MoveList&                   moves,
+        std::array<i32, N_PITS>&    scores,
+        i32                         depth,
+        i32                         alpha,
+        i32                         beta
+    );
+
+    /**
+     * @brief Moves the best root move to the front and sorts the rest by their
+     * last scores.
+     *
+     * @details If the search is deterministic, the rest keep their order since
+     * their scores are bounds that depend on timing.
+     */
+    void order_root_moves(Game game, MoveList& moves, std::array<i32, N_PITS>& scores, size best) const;
+
+    /**
+     * @brief Shares the node count and, on the main thread, stops the search if
+     * it is out of time or nodes.
+     */
+    void check_limits();
+
+    /**
+     * @brief Adds this search's statistics to the shared statistics.
+     */
+    void share_stats();
+
+    /**
+     * @brief Returns the given iteration result with the counts of every
+     * thread so far, for reporting progress.
+     */
+    Result progress(const Result& result, Clock::time_point iterStart);
+
+    /**
+     * @brief Counts a beta cutoff by the move at the given index of the ordered
+     * moves, the last index counting every later one too.
+     */
+    inline void count_cutoff(const size i) {
+        if constexpr (STATS)
+            stats.cutoffs[std::min(i, N_PITS - 1)]++;
+    }
+
+    /**
+     * @brief Returns the milliseconds passed since the given time.
+     */
+    static f64 elapsed_ms(Clock::time_point since);
+
+    /**
+     * @brief Returns the legal moves sorted by instant potential in ascending order.
+     *
+     * @details The last iteration's principal variation move, then the best
+     * move from the transposition table, come first if given. The rest are
+     * ordered by `score_move`.
+     */
+    MoveList get_sorted_moves(Game game, u8 ttMove, u8 pvMove, i32 ply) const;
+
+    /**
+     * @brief Returns the last iteration's principal variation move at the given
+     * ply if the search is still following it, or 0 if not.
+     */
+    u8 next_pv_move(i32 ply);
+
+    /**
+     * @brief Plays on to the end of the next chain in `chains`, writing the
+     * position it ends in.
+     *
+     * @details A chain ends where the turn passes, the game ends, the position
+     * is solved, the depth runs out, or a previous search of the position is
+     * usable in the window. Links are played depth first, each link's moves
+     * sorted as a node at its ply would sort them, so chains come out in the
+     * order the links would have been searched as nodes of their own. Chains
+     * meeting one given out before are skipped.
+     *
+     * @return `false` once every chain has been given out.
+     */
+    bool next_chain(ChainList& chains, bool isPovTurn, i32 depth, i32 ply, i32 a, i32 b, Game& child);
+
+    /**
+     * @brief Searches the position reached by a move of the side given by
+     * `isPovTurn`, returning its score for that side.
+     *
+     * @details The window is from the mover's perspective too; it is only
+     * negated when the move passed the turn, since a chain keeps it.
+     */
+    i32 search_child(Game child, bool isPovTurn, i32 depth, i32 ply, i32 a, i32 b);
+
+    /**
+     * @brief Searches a node one ply from the horizon as `negamax` would, but
+     * evaluates its children after the first in one batch, passing each
+     * evaluation on to `quiesce`.
+     *
+     * @details Only for when there's no tablebase, which the batch can't see.
+     * Nothing is stored in the table at this depth.
+     */
+    i32 search_frontier(const Game& game, MoveList& moves, i32 ply, i32 a, i32 b);
+
+    /**
+     * @brief Makes the move and searches the resulting position, returning its
+     * score for the side that made the move.
+     *
+     * @details The window is from the mover's perspective too; it is only
+     * negated when the move passes the turn, since a chain keeps it.
+     */
+    i32 search_move(Game game, u8 move, i32 depth, i32 ply, i32 a, i32 b);
+
+    /**
+     * @brief Like `search_move`, but splits nodes across the pool.
+     */
+    i32 search_move_split(Game game, u8 move, i32 depth, i32 ply, i32 a, i32 b, const SplitPoint* sp);
+
+    /**
+     * @brief Negamax principal variation search: the first move is searched
+     * with the full window and the rest with a null window, being searched
+     * again if they turn out better.
+     *
+     * @details Each move is a whole chain from `next_chain`, so only the
+     * positions where the turn passes are searched as nodes, and chains that
+     * meet are searched once. Scores are from the side to move's perspective.
+     * The principal variation from the position is written to `pv[ply]`.
+     */
+    i32 negamax(Game game, i32 depth, i32 ply, i32 a, i32 b);
+
+    /**
+     * @brief Negamax principal variation search that splits nodes across the
+     * pool with Young Brothers Wait: the first move is searched serially, then
+     * the rest in parallel.
+     *
+     * @details Returns 0 if the search was stopped or `sp` was cut off.
+     */
+    i32 negamax_split(Game game, i32 depth, i32 ply, i32 a, i32 b, const SplitPoint* sp);
+
+    /**
+     * @brief Quiescence search past the horizon: the side to move may stand
+     * pat on the evaluation or play a capture or a chain, so the evaluation is
+     * only trusted once no tactics are pending.
+     *
+     * @details Captures that could not raise the score to alpha even with the
+     * stones they take are skipped (delta pruning). Runs on `Position`, whose
+     * moves pass the turn without branching. Scores are from the side
+     * to move's perspective, as is `eval`, the position's evaluation when a
+     * batch has already scored it.
+     */
+    i32 quiesce(Position position, i32 ply, i32 a, i32 b, std::optional<i32> eval = std::nullopt);
+
+    /**
+     * @brief `quiesce` from the position reached by a move of the side given
+     * by `isPovTurn`, with its evaluation and window from that side's
+     * perspective, returning its score for that side.
+     */
+    i32 quiesce_child(Position child, bool isPovTurn, i32 eval, i32 ply, i32 a, i32 b);
+
+    /**
+     * @brief Searches a move of a split point and merges its score, also
+     * writing it to `out` and its principal variation to `outPv` if given.
+     *
+     * @note Runs as a pool task; `game` is the split point's position and
+     * `ply` is the ply after the move.
+     */
+    void search_sibling(Game game, u8 move, i32 depth, i32 ply, SplitPoint& sp, i32* out, Line* outPv);
+
+    /**
+     * @brief Runs pool tasks as this search's worker until the split point's
+     * siblings are done.
+     */
+    void wait_for(const SplitPoint& sp);
+
+    /**
+     * @brief Returns `true` if the tablebase has the position's exact result.
+     */
+    bool is_solved(const Game& game);
+
+    /**
+     * @brief `is_solved` for a position.
+     */
+    bool is_solved(const Position& position);
+
+    /**
+     * @brief Returns the evaluation of the position for the side to move,
+     * exact if it is in the tablebase.
+     *
+     * @details A win or loss is scored by its distance from the root, so the
+     * search prefers the fastest win and the slowest loss.
+     */
+    i32 evaluate(const Game& game, i32 ply);
+
+    /**
+     * @brief `evaluate` for a position.
+     */
+    i32 evaluate(const Position& position, i32 ply);
+
+    /**
+     * @brief Counts a child scored in a batch as a searched node, returning its
+     * score.
+     */
+    i32 count_leaf(i32 score, i32 ply);
+
+    /**
+     * @brief Returns the lowest and highest scores the mancalas still allow
+     * the side to move in a tuple, for a position that isn't decided.
+     */
+    static std::tuple<i32, i32> result_bounds(const Game& game, i32 ply);
+
+    /**
+     * @brief Returns `true` if the score is a win or a loss.
+     */
+    static inline bool is_decided(const i32 score) {
+        return std::abs(score) >= DECIDED_SCORE;
+    }
+
+    /**
+     * @brief Returns the table entry for the position, its score made
+     * relative to the given ply.
+     */
+    std::optional<TTable::Entry> probe_table(u64 key, i32 ply) const;
+
+    /**
+     * @brief Stores a search result found at the given ply in the table.
+     *
+     * @details Wins and losses are stored by their distance from the position
+     * rather than the root, so they stay right when it's reached at another ply.
+     */
+    void store_table(u64 key, i32 depth, i32 score, TTable::Bound bound, u8 move, i32 ply);
+
+    /**
+     * @brief Returns `true` if the table entry can decide the position's score.
+     */
+    bool is_usable(const TTable::Entry& entry, i32 depth, i32 a, i32 b) const;
+
+    /**
+     * @brief Scores the given move for ordering: captures, then chains, then
+     * the rest by pit, ties broken by killers, the counter move and history.
+     */
+    i32 score_move(Side u, Side o, u8 move, i32 ply, bool isPovTurn) const;
+
+    /**
+     * @brief Scores the given move by what it does on the board alone.
+     */
+    static i32 score_tactics(Side u, Side o, u8 move);
+
+    /**
+     * @brief Returns the number of the opponent's stones the move captures, 0
+     * if it isn't a capture.
+     */
+    static i32 n_captured(Side u, Side o, u8 move);
+
+    /**
+     * @brief Learns from the move causing a cutoff: it becomes a killer and
+     * the counter move, and gains history while the moves tried before it
+     * lose some.
+     */
+    void update_ordering(u8 move, std::span<const u8> tried, i32 depth, i32 ply, bool isPovTurn);
+
+    /**
+     * @brief Returns a move's index into `counterMoves`.
+     */
+    static inline u8 move_index(const bool isPovTurn, const u8 move) {
+        return isPovTurn ? static_cast<u8>(move + N_PITS) : move;
+    }
+};
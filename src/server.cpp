@@ -0,0 +1,351 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "parse.h"
+
+namespace {
+    /**
+     * @brief Reads a file descriptor a line at a time.
+     */
+    class LineReader {
+    private:
+        i32         fd;
+        std::string buffer;
+
+    public:
+        explicit LineReader(const i32 fd) : fd(fd), buffer() {
+
+        }
+
+        /**
+         * @brief Reads the next line, without its newline, into `line`.
+         *
+         * @return `false` at the end of input or on an error, `true` if not.
+         */
+        bool next(std::string& line) {
+            size newline = buffer.find('\n');
+            while (newline == std::string::npos) {
+                char        chunk[4096];
+                const auto  n = ::read(fd, chunk, sizeof(chunk));
+                if (n <= 0)
+                    return false;
+
+                buffer.append(chunk, static_cast<size>(n));
+                newline = buffer.find('\n');
+            }
+
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+    };
+}
+
+Server::Connection::Connection(const i32 fd, const bool isSocket) : fd(fd), isSocket(isSocket), writeMutex() {
+
+}
+
+Server::Connection::~Connection() {
+    if (isSocket)
+        ::close(fd);
+}
+
+void Server::Connection::send(const std::string& line) {
+    const std::string       out     = line + '\n';
+    std::lock_guard         lock(writeMutex);
+    for (size done = 0; done < out.size(); ) {
+        const auto n = isSocket
+            ? ::send(fd, out.data() + done, out.size() - done, MSG_NOSIGNAL)
+            : ::write(fd, out.data() + done, out.size() - done);
+        if (n <= 0)
+            return;
+
+        done += static_cast<size>(n);
+    }
+}
+
+Server::Server(const size nWorkers, const size mb) :
+    table(mb),
+    engines(),
+    workers(),
+    mutex(),
+    isReady(),
+    slots(),
+    ready(),
+    quit(false),
+    nAnswered(0),
+    listenFd(-1)
+{
+    const size n = std::clamp<size>(nWorkers, 1, AI::MAX_THREADS);
+    for (size i = 0; i < n; i++)
+        engines.push_back(std::make_unique<AI>(table));
+    for (size i = 0; i < n; i++)
+        workers.emplace_back([this, i](){ work(i); });
+}
+
+Server::~Server() {
+    {
+        std::lock_guard lock(mutex);
+        quit = true;
+    }
+    isReady.notify_all();
+    for (auto& worker: workers)
+        worker.join();
+}
+
+void Server::serve(const i32 fd) {
+    serve(std::make_shared<Connection>(fd, true));
+}
+
+void Server::serve(const std::shared_ptr<Connection>& connection) {
+    LineReader reader(connection->fd);
+    serve([&reader](std::string& line){ return reader.next(line); }, connection);
+}
+
+void Server::serve_stdin() {
+    // Read through `std::cin`, which may already hold lines after the command
+    // that started the server.
+    serve([](std::string& line){ return static_cast<bool>(std::getline(std::cin, line)); }, std::make_shared<Connection>(STDOUT_FILENO, false));
+}
+
+void Server::serve(const Reader& next, const std::shared_ptr<Connection>& connection) {
+    std::string line;
+    while (next(line)) {
+        std::istringstream  toks(line);
+        std::string         id;
+        if (!(toks >> id))
+            continue;
+        if (id == "quit")
+            break;
+        if (id == "shutdown") {
+            // Wake the accept loop; it closes the other connections.
+            const i32 fd = listenFd.exchange(-1);
+            if (fd >= 0)
+                ::shutdown(fd, SHUT_RDWR);
+            break;
+        }
+
+        std::string rest;
+        std::getline(toks >> std::ws, rest);
+        if (rest.empty()) {
+            connection->send(std::format("{} error missing command", id));
+            continue;
+        }
+
+        submit(id, Job{ rest, connection, Search::Clock::now() });
+    }
+}
+
+bool Server::listen(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const i32 fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    // Replace a socket left behind by an earlier server.
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return false;
+    }
+    listenFd = fd;
+
+    // Each client is joined once it's done, and its socket closed by the last
+    // of its queued requests.
+    std::list<Client> clients;
+    while (true) {
+        for (auto it = clients.begin(); it != clients.end(); ) {
+            if (it->isDone) {
+                it->thread.join();
+                it = clients.erase(it);
+            } else
+                it++;
+        }
+
+        const i32 clientFd = ::accept(fd, nullptr, nullptr);
+        if (clientFd < 0) {
+            if (listenFd < 0)
+                break;
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                // Leave the client in the backlog until a socket closes.
+                std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_RETRY));
+                continue;
+            }
+            break;
+        }
+
+        const auto  connection  = std::make_shared<Connection>(clientFd, true);
+        Client&     client      = clients.emplace_back();
+        client.connection   = connection;
+        client.thread       = std::thread([this, &client, connection](){
+            serve(connection);
+            client.isDone = true;
+        });
+    }
+
+    // Stop reading from the remaining clients; queued requests still finish.
+    listenFd = -1;
+    for (auto& client: clients) {
+        if (const auto connection = client.connection.lock())
+            ::shutdown(connection->fd, SHUT_RD);
+    }
+    for (auto& client: clients)
+        client.thread.join();
+
+    ::close(fd);
+    ::unlink(path.c_str());
+
+    return true;
+}
+
+size Server::n_workers() const {
+    return workers.size();
+}
+
+void Server::submit(const std::string& id, Job job) {
+    {
+        std::lock_guard lock(mutex);
+        Slot& slot = slots[id];
+        slot.pending.push_back(std::move(job));
+        if (slot.pending.size() > 1 || slot.isRunning)
+            return;
+
+        ready.push_back(id);
+    }
+    isReady.notify_one();
+}
+
+void Server::work(const size worker) {
+    AI& ai = *engines[worker];
+    std::unique_lock lock(mutex);
+    while (true) {
+        isReady.wait(lock, [this](){ return quit || !ready.empty(); });
+        if (ready.empty())
+            return;
+
+        // Take one request from the game that has waited longest.
+        const std::string   id      = std::move(ready.front());
+        Slot&               slot    = slots[id];
+        const Job           job     = std::move(slot.pending.front());
+        ready.pop_front();
+        slot.pending.pop_front();
+        slot.isRunning = true;
+
+        // Only this worker touches the game until it's done, and the map
+        // doesn't move its elements.
+        lock.unlock();
+        bool                isFreed = false;
+        const std::string   answer  = run(ai, slot, job, isFreed);
+        job.connection->send(std::format("{} {}", id, answer));
+        lock.lock();
+
+        // The engines don't age the table they share, as one search starting
+        // would make the others' entries replaceable, so age it every so many answers.
+        if (++nAnswered % AGE_INTERVAL == 0)
+            table.new_search();
+
+        slot.isRunning = false;
+        if (!slot.pending.empty())
+            ready.push_back(id);
+        else if (isFreed)
+            slots.erase(id);
+
+        // Wake a worker for the game.
+        isReady.notify_one();
+    }
+}
+
+std::string Server::run(AI& ai, Slot& slot, const Job& job, bool& isFreed) {
+    std::istringstream  toks(job.command);
+    std::string         cmd;
+    toks >> cmd;
+
+    if (cmd == "new") {
+        slot.game = Game();
+        return "ok";
+    } else if (cmd == "free") {
+        // Requests already queued behind this one start from a new game.
+        slot.game   = Game();
+        isFreed     = true;
+        return "ok";
+    } else if (cmd == "move") {
+        Game        next    = slot.game;
+        std::string tok;
+        while (toks >> tok) {
+            const auto move = parse_ulong(tok);
+            if (!move || move.value() < 1 || move.value() > N_PITS || !next.make_move(move.value()))
+                return std::format("error illegal move {}", tok);
+        }
+
+        slot.game = next;
+        return "ok";
+    } else if (cmd == "go") {
+        AI::Limits  limits      = { 0, 0, 0 };
+        u64         deadline    = 0;
+        std::string tok;
+        while (toks >> tok) {
+            std::string val;
+            toks >> val;
+            const auto n = parse_ulong(val);
+            if (!n)
+                return std::format("error bad value for {}: \"{}\"", tok, val);
+
+            if (tok == "depth")
+                limits.depth = static_cast<i32>(std::min<u64>(n.value(), AI::MAX_DEPTH));
+            else if (tok == "movetime")
+                limits.movetime = n.value();
+            else if (tok == "nodes")
+                limits.nodes = n.value();
+            else if (tok == "deadline")
+                deadline = n.value();
+            else
+                return std::format("error unknown go argument {}", tok);
+        }
+        if (slot.game.is_over())
+            return "error game over";
+
+        // Unlimited searches get the default time, and none may outlast the
+        // deadline, counted from when the request arrived.
+        if (limits.depth == 0 && limits.movetime == 0 && limits.nodes == 0)
+            limits.movetime = DEFAULT_MOVETIME;
+        if (deadline > 0) {
+            const auto waited = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                Search::Clock::now() - job.received
+            ).count());
+            if (waited >= deadline)
+                return "error deadline";
+
+            limits.movetime = limits.movetime > 0
+                ? std::min(limits.movetime, deadline - waited)
+                : deadline - waited;
+        }
+        if (limits.depth == 0)
+            limits.depth = AI::MAX_DEPTH;
+
+        const auto result = ai.find_move(slot.game, limits);
+        return std::format(
+            "bestmove {} score {} depth {} nodes {} time {}",
+            result.move, result.mover_score(slot.game.is_pov_turn()), result.depth, result.nodes, result.time
+        );
+    } else {
+        return std::format("error unknown command {}", cmd);
+    }
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ai.h"
+#include "def.h"
+#include "game.h"
+#include "search.h"
+#include "ttable.h"
+
+/**
+ * @brief Hosts many independent games at once, answering line-based requests
+ * from stdin or a Unix socket.
+ *
+ * @details Each request names a game by id. Requests are queued per game and
+ * run in order on a fixed pool of workers, each with its own engine but one
+ * transposition table shared by all. Games take turns: a worker takes one
+ * request from the game at the front of the ready queue, then sends the game
+ * to the back if it has more, so a busy game can't starve the rest.
+ */
+class Server {
+public:
+    /**
+     * @brief The default number of workers.
+     */
+    static constexpr inline size DEFAULT_WORKERS = 4;
+
+    /**
+     * @brief The default size of the shared transposition table in megabytes.
+     */
+    static constexpr inline size DEFAULT_MB = 256;
+
+    /**
+     * @brief The time budget of a "go" without limits, in milliseconds.
+     */
+    static constexpr inline u64 DEFAULT_MOVETIME = 100;
+
+    /**
+     * @brief How long `listen` waits to accept again when out of file
+     * descriptors, in milliseconds.
+     */
+    static constexpr inline u64 ACCEPT_RETRY = 10;
+
+    /**
+     * @brief The number of requests answered between each aging of the shared
+     * table.
+     */
+    static constexpr inline u64 AGE_INTERVAL = 256;
+
+private:
+    /**
+     * @brief Where requests are read from and answers written to.
+     */
+    struct Connection {
+        /**
+         * @brief The file descriptor answers are written to.
+         */
+        i32 fd;
+
+        /**
+         * @brief Is `true` if `fd` is a socket, which the connection owns and
+         * which must not raise `SIGPIPE` when the client has gone.
+         */
+        bool isSocket;
+
+        /**
+         * @brief Keeps answers to the same connection whole.
+         */
+        std::mutex writeMutex;
+
+        Connection(i32 fd, bool isSocket);
+
+        /**
+         * @brief Closes `fd` if it's a socket, once the reader and every
+         * queued request are done with it.
+         */
+        ~Connection();
+
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        /**
+         * @brief Writes the line, dropping it if the client has gone.
+         */
+        void send(const std::string& line);
+    };
+
+    /**
+     * @brief A client of `listen` and the thread reading its requests.
+     */
+    struct Client {
+        std::thread thread;
+
+        /**
+         * @brief The client's connection, while anything still holds it.
+         */
+        std::weak_ptr<Connection> connection;
+
+        /**
+         * @brief Set by `thread` when it's done reading, so it can be joined.
+         */
+        std::atomic<bool> isDone;
+    };
+
+    /**
+     * @brief A request waiting for a worker.
+     */
+    struct Job {
+        /**
+         * @brief The command and its arguments, after the game id.
+         */
+        std::string command;
+
+        /**
+         * @brief Where to answer.
+         */
+        std::shared_ptr<Connection> connection;
+
+        /**
+         * @brief When the request was read.
+         */
+        Search::Clock::time_point received;
+    };
+
+    /**
+     * @brief A game and the requests for it not yet answered.
+     */
+    struct Slot {
+        Game game;
+
+        std::deque<Job> pending;
+
+        /**
+         * @brief Is `true` while a worker is running one of its requests.
+         */
+        bool isRunning;
+    };
+
+    /**
+     * @brief The transposition table every worker searches with.
+     */
+    TTable table;
+
+    /**
+     * @brief Each worker's engine, searching with `table`.
+     */
+    std::vector<std::unique_ptr<AI>> engines;
+
+    /**
+     * @brief The worker threads.
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * @brief Guards `slots`, `ready`, `quit`, and `nAnswered`.
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief Signals workers that a game is ready or the server is quitting.
+     */
+    std::condition_variable isReady;
+
+    /**
+     * @brief The games by id.
+     */
+    std::unordered_map<std::string, Slot> slots;
+
+    /**
+     * @brief The ids of the games with pending requests and none running, in
+     * the order they are served.
+     */
+    std::deque<std::string> ready;
+
+    /**
+     * @brief Set to make the workers exit.
+     */
+    bool quit;
+
+    /**
+     * @brief The number of requests answered, counting toward the next aging
+     * of `table`.
+     */
+    u64 nAnswered;
+
+    /**
+     * @brief The listening socket, or -1 if not listening.
+     */
+    std::atomic<i32> listenFd;
+
+public:
+    /**
+     * @brief A server with the given number of workers and shared table size
+     * in megabytes.
+     */
+    Server(size nWorkers, size mb);
+
+    /**
+     * @brief Finishes the queued requests, then stops the workers.
+     */
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * @brief Reads requests from the connected socket and answers them on it
+     * until the end of input or "quit", taking ownership of the socket, which
+     * is closed once its queued requests are answered.
+     */
+    void serve(i32 fd);
+
+    /**
+     * @brief Reads requests from stdin and answers them on stdout until the
+     * end of input or "quit".
+     */
+    void serve_stdin();
+
+    /**
+     * @brief Listens on a Unix socket at the given path, serving each client
+     * on its own thread, until a client sends "shutdown".
+     *
+     * @return `false` if the socket could not be set up, `true` if not.
+     */
+    bool listen(const std::string& path);
+
+    /**
+     * @brief Returns the number of workers.
+     */
+    size n_workers() const;
+
+private:
+    /**
+     * @brief Reads the next request line into its argument, returning `false`
+     * at the end of input.
+     */
+    using Reader = std::function<bool(std::string&)>;
+
+    /**
+     * @brief Reads requests from the connection's socket and answers them on
+     * it until the end of input or "quit".
+     */
+    void serve(const std::shared_ptr<Connection>& connection);
+
+    /**
+     * @brief Reads requests with `next` and queues them, answering on
+     * `connection`, until the end of input or "quit".
+     */
+    void serve(const Reader& next, const std::shared_ptr<Connection>& connection);
+
+    /**
+     * @brief Queues the request for its game, readying the game if it was idle.
+     */
+    void submit(const std::string& id, Job job);
+
+    /**
+     * @brief Runs requests until `quit` is set and none are left.
+     */
+    void work(size worker);
+
+    /**
+     * @brief Runs the request on the game and returns the answer, without
+     * the id.
+     */
+    std::string run(AI& ai, Slot& slot, const Job& job, bool& isFreed);
+};
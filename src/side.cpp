@@ -1,16 +1,102 @@
 #include "side.h"
 
 #include <algorithm>
+#include <array>
 
 #include "config.h"
 #include "def.h"
 
+namespace {
+    /**
+     * @brief What sowing a pit holding some number of stones does to the board.
+     */
+    struct Sowing {
+        /**
+         * @brief Added to the user's side, emptying the sown pit by wrapping
+         * around.
+         */
+        u64 user;
+
+        /**
+         * @brief Added to the opponent's side.
+         */
+        u64 op;
+
+        /**
+         * @brief The user's pit the last stone lands in, 0 for the mancala, or
+         * `N_PITS + 1` if it can't capture or chain.
+         */
+        u8 last;
+    };
+
+    /**
+     * @brief Returns every pit and stone count's sowing, by dropping the
+     * stones one at a time.
+     */
+    consteval std::array<std::array<Sowing, N_STONES + 1>, N_PITS> make_sowings() {
+        std::array<std::array<Sowing, N_STONES + 1>, N_PITS> sowings = {};
+        for (u64 pit = 1; pit <= N_PITS; pit++) {
+            for (u64 nStones = 0; nStones <= N_STONES; nStones++) {
+                Sowing  sowing  = { 0 - (nStones << (8 * pit)), 0, static_cast<u8>(N_PITS + 1) };
+                bool    isUser  = true;
+                u64     i       = pit;
+                for (u64 j = 0; j < nStones; j++) {
+                    // Stones go down the user's pits to the mancala, then down
+                    // the opponent's pits, skipping its mancala.
+                    if (isUser && i == 0) {
+                        isUser  = false;
+                        i       = N_PITS;
+                    } else if (!isUser && i == 1) {
+                        isUser  = true;
+                        i       = N_PITS;
+                    } else
+                        i--;
+
+                    (isUser ? sowing.user : sowing.op) += 1ULL << (8 * i);
+                }
+
+                // A last stone coming back around past the opponent's pits
+                // doesn't capture or chain, as in `sow_shifts`.
+                if (nStones > 0 && isUser && nStones % (2 * N_PITS + 1) <= pit)
+                    sowing.last = static_cast<u8>(i);
+                sowings[pit - 1][nStones] = sowing;
+            }
+        }
+
+        return sowings;
+    }
+
+    /**
+     * @brief The sowings of each pit (index 0 is pit #1), by stone count.
+     */
+    constexpr std::array<std::array<Sowing, N_STONES + 1>, N_PITS> SOWINGS = make_sowings();
+}
+
 Side::Side(const bool isTurn) : pits(PIT_ONES * N_STARTING_STONES) {
     // Activate turn bit if it's this side's turn.
     if (isTurn)
         pits |= TURN_BIT;
 }
 
+Side Side::from_pits(const std::array<u8, N_PITS>& pits, const u8 mancala, const bool isTurn) {
+    Side side(isTurn);
+
+    // Replace the starting stones.
+    side.pits &= TURN_BIT;
+    side.pits |= mancala;
+    for (size i = 0; i < N_PITS; i++)
+        side.pits |= static_cast<u64>(pits[i]) << (8 * (i + 1));
+
+    return side;
+}
+
+Side Side::from_bits(const u64 bits) {
+    Side side(false);
+    side.pits = bits;
+
+    return side;
+}
+
 bool Side::has_moves() const {
     return (pits & PIT_MASK) != 0;
 }
@@ -20,7 +106,34 @@ bool Side::has_turn() const {
 }
 
 __attribute__((hot))
-bool Side::make_move(const u8 i, Side& op) {
+bool Side::sow_table(const u8 i, Side& op) {
+    const Sowing& sowing = SOWINGS[i - 1][pit_i(i * 8)];
+    pits    += sowing.user;
+    op.pits += sowing.op;
+
+    if (sowing.last == 0)
+        // Chain moves.
+        return true;
+
+    if (sowing.last <= N_PITS) {
+        // Capture if the last stone landed in an empty pit across from stones.
+        const u64 myPitI    = 8 * sowing.last;
+        const u64 opPitI    = 8 * (N_PITS + 1 - sowing.last);
+        const u64 nMyStones = pit_i(myPitI);
+        const u64 nOpStones = op.pit_i(opPitI);
+
+        if (nMyStones == 1 && nOpStones > 0) {
+            pits    += nMyStones + nOpStones;
+            pits    -= nMyStones << myPitI;
+            op.pits -= nOpStones << opPitI;
+        }
+    }
+
+    return false;
+}
+
+__attribute__((hot))
+bool Side::sow_shifts(const u8 i, Side& op) {
     // Take the stones out of the pit.
     const u64   p       = i * 8;
     u64         nStones = static_cast<u64>(pit_i(p));
@@ -1,14 +1,28 @@
 #pragma once
 
+#include <array>
+
+#include "config.h"
 #include "def.h"
 
 class Side {
-private:
+public:
+    /**
+     * @brief Is `true` if moves are sown with precomputed tables, `false` if
+     * with masks computed per move (built with `ROCKHOP_SOW_SHIFTS`).
+     */
+#ifdef ROCKHOP_SOW_SHIFTS
+    static constexpr inline bool SOW_TABLES = false;
+#else
+    static constexpr inline bool SOW_TABLES = true;
+#endif
+
     /**
      * @brief the turn bit.
      */
     static constexpr u64 TURN_BIT       = 0x8000000000000000ULL;
 
+private:
     /**
      * @brief A side with all pits holding one stone.
      */
@@ -54,6 +68,16 @@ private:
 public:
     Side(bool isTurn);
 
+    /**
+     * @brief A side with the given pits (index 0 is pit #1) and mancala.
+     */
+    static Side from_pits(const std::array<u8, N_PITS>& pits, u8 mancala, bool isTurn);
+
+    /**
+     * @brief The side with the given packed bitmap, as returned by `bits`.
+     */
+    static Side from_bits(u64 bits);
+
     /**
      * @brief Returns the number of stones in the pit at the given index.
      */
@@ -68,6 +92,21 @@ public:
         return static_cast<i32>(man);
     }
 
+    /**
+     * @brief Returns the side's packed bitmap.
+     */
+    inline u64 bits() const {
+        return pits;
+    }
+
+    /**
+     * @brief Returns the number of stones in the side's pits, excluding the mancala.
+     */
+    inline i32 n_pit_stones() const {
+        // Sum the pit bytes into the top byte; the total never overflows it.
+        return static_cast<i32>(((pits & PIT_MASK) * 0x0101010101010101ULL) >> 56);
+    }
+
     /**
      * @brief Returns `true` if the side has at least one move they can make,
      * `false` if not.
@@ -82,7 +121,24 @@ public:
     /**
      * @brief Makes the given move. Returns `true` if the user can move again.
      */
-    bool make_move(u8 move, Side& op);
+    inline bool make_move(u8 move, Side& op) {
+        if constexpr (SOW_TABLES)
+            return sow_table(move, op);
+        else
+            return sow_shifts(move, op);
+    }
+
+    /**
+     * @brief Makes the given move by adding what a table holds for the pit and
+     * its stone count to both sides. Returns `true` if the user can move again.
+     */
+    bool sow_table(u8 move, Side& op);
+
+    /**
+     * @brief Makes the given move by building masks of the pits it sows.
+     * Returns `true` if the user can move again.
+     */
+    bool sow_shifts(u8 move, Side& op);
 
     /**
      * @brief Moves all stones in the pits to the mancala.
@@ -0,0 +1,231 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include "movelist.h"
+
+Solver::Solver() :
+    table(),
+    limits(),
+    startTime(),
+    tablebase(nullptr),
+    nodes(0),
+    halt(nullptr),
+    stopped(false),
+    rootMove(0)
+{
+
+}
+
+void Solver::clear() {
+    if (table)
+        std::fill_n(table.get(), 1ULL << TABLE_BITS, 0);
+}
+
+std::optional<Solver::Solution> Solver::solve(const Game& game, const Search::Limits& limits, const Tablebase* tablebase, const std::atomic<bool>* halt) {
+    if (game.is_over() || game.n_pit_stones() > static_cast<i32>(MAX_STONES))
+        return std::nullopt;
+
+    // Engines that never solve, or don't yet, shouldn't pay for the table.
+    if (!table)
+        table = std::make_unique<u64[]>(1ULL << TABLE_BITS);
+
+    this->limits    = limits;
+    this->tablebase = tablebase;
+    this->halt      = halt;
+    startTime       = Search::Clock::now();
+    nodes           = 0;
+    stopped         = false;
+    rootMove        = 0;
+
+    const i32 nStones   = game.n_pit_stones();
+    const i32 value     = search(game, -nStones, nStones, true);
+    if (stopped)
+        return std::nullopt;
+
+    // Add what's left to capture to what's already in the mancalas.
+    const auto  [a, b]      = game.get_sides();
+    Solution    solution    = {};
+    solution.move   = rootMove;
+    solution.diff   = a.mancala() - b.mancala() + (game.is_pov_turn() ? value : -value);
+
+    // Follow the best moves through the table for the line, solving again
+    // where a cutoff left a position without one, so the line reaches the end.
+    Game child = game;
+    for (u8 move = rootMove; move != 0 && solution.pv.length < Search::MAX_DEPTH; ) {
+        solution.pv.moves[solution.pv.length++] = move;
+        child.make_move_unchecked(move);
+        if (child.is_over())
+            break;
+
+        const auto entry = probe(key(child));
+        if (entry && entry->move != 0)
+            move = entry->move;
+        else {
+            const i32 nChildStones = child.n_pit_stones();
+            search(child, -nChildStones, nChildStones, true);
+            move = stopped ? 0 : rootMove;
+        }
+    }
+    solution.nodes = nodes;
+
+    return solution;
+}
+
+u64 Solver::n_nodes() const {
+    return nodes;
+}
+
+__attribute__((hot))
+i32 Solver::search(const Game& game, i32 a, i32 b, const bool isRoot) {
+    // Give up once out of time or nodes.
+    if (++nodes % CHECK_INTERVAL == 0)
+        check_limits();
+    if (stopped)
+        return 0;
+
+    const bool  isPovTurn   = game.is_pov_turn();
+    const auto  [pa, pb]    = game.get_sides();
+    const i32   mancalaDiff = isPovTurn ? pa.mancala() - pb.mancala() : pb.mancala() - pa.mancala();
+
+    // Use the exact result if it's known.
+    if (!isRoot && tablebase != nullptr) {
+        if (const auto diff = tablebase->probe(game))
+            return (isPovTurn ? diff.value() : -diff.value()) - mancalaDiff;
+    }
+
+    // Neither side can capture more than the stones left in the pits.
+    const i32 nStones = game.n_pit_stones();
+    if (a >= nStones)
+        return nStones;
+    if (b <= -nStones)
+        return -nStones;
+    a = std::max(a, -nStones);
+    b = std::min(b, nStones);
+
+    // Narrow the window to what previous solves proved.
+    const u64   posKey  = key(game);
+    const auto  entry   = probe(posKey);
+    if (entry && !isRoot) {
+        if (entry->lower >= b)
+            return entry->lower;
+        if (entry->upper <= a)
+            return entry->upper;
+        if (entry->lower == entry->upper)
+            return entry->lower;
+        a = std::max(a, entry->lower);
+        b = std::min(b, entry->upper);
+    }
+
+    // Play every move first to try the best looking ones first: the table's
+    // best move, then by the stones they gain, chains breaking ties.
+    std::array<Child, N_PITS>   children    = {};
+    size                        nChildren   = 0;
+    const u8                    tableMove   = entry ? entry->move : 0;
+    for (const auto move: game.legal_moves()) {
+        Child child = { game, 0, move, 0 };
+        child.game.make_move_unchecked(move);
+
+        const auto [ca, cb] = child.game.get_sides();
+        child.gain  = (isPovTurn ? ca.mancala() - cb.mancala() : cb.mancala() - ca.mancala()) - mancalaDiff;
+        child.order = move == tableMove
+            ? ORDER_TABLE_MOVE
+            : child.gain * 2 + (child.game.is_pov_turn() == isPovTurn && !child.game.is_over());
+
+        size j = nChildren++;
+        for (; j > 0 && children[j - 1].order < child.order; j--)
+            children[j] = children[j - 1];
+        children[j] = child;
+    }
+
+    const i32   origA       = a;
+    i32         best        = -static_cast<i32>(N_STONES);
+    u8          bestMove    = 0;
+    for (size i = 0; i < nChildren; i++) {
+        const auto& [child, gain, move, order] = children[i];
+
+        // Score the stones the move put in the mancalas, then what's left.
+        i32 value = gain;
+        if (!child.is_over()) {
+            // A chain keeps the turn, and with it the perspective.
+            value += child.is_pov_turn() == isPovTurn
+                ? search(child, a - gain, b - gain, false)
+                : -search(child, gain - b, gain - a, false);
+        }
+        if (stopped)
+            return 0;
+
+        if (value > best) {
+            best        = value;
+            bestMove    = move;
+        }
+        a = std::max(a, best);
+        if (a >= b)
+            break;
+    }
+
+    if (isRoot)
+        rootMove = bestMove;
+
+    // Only a score within the window is exact.
+    const i32 lower = best >= b ? best : best > origA ? best : -nStones;
+    const i32 upper = best <= origA ? best : best >= b ? nStones : best;
+    store(posKey, std::max(lower, entry ? entry->lower : -nStones), std::min(upper, entry ? entry->upper : nStones), bestMove);
+
+    return best;
+}
+
+u64 Solver::key(const Game& game) {
+    const auto [u, o] = game.get_turn_user_opp();
+
+    u64 packed = 0;
+    for (u8 i = 1; i <= N_PITS; i++)
+        packed = (packed << 10) | static_cast<u64>(u.pit(i) << 5) | static_cast<u64>(o.pit(i));
+
+    return packed;
+}
+
+u64 Solver::scramble(u64 key) {
+    // Odd multiples and right shifts can be undone, so no two keys collide.
+    key = (key * 0x9E3779B97F4A7C15ULL) & KEY_MASK;
+    key ^= key >> 29;
+    key = (key * 0xBF58476D1CE4E5B9ULL) & KEY_MASK;
+    return key;
+}
+
+std::optional<Solver::Entry> Solver::probe(const u64 key) const {
+    const u64 scrambled = scramble(key);
+    const u64 data      = table[scrambled & ((1ULL << TABLE_BITS) - 1)];
+
+    // Slots hold the key's high bits above the packed bounds and move.
+    if (data == 0 || (data >> 17) != (scrambled >> TABLE_BITS) + 1)
+        return std::nullopt;
+
+    return Entry{
+        static_cast<i32>(data & 0x7F) - VALUE_OFFSET,
+        static_cast<i32>((data >> 7) & 0x7F) - VALUE_OFFSET,
+        static_cast<u8>((data >> 14) & 0x7),
+    };
+}
+
+void Solver::store(const u64 key, const i32 lower, const i32 upper, const u8 move) {
+    const u64 scrambled = scramble(key);
+
+    // The high bits are offset by one so no stored slot reads as empty.
+    table[scrambled & ((1ULL << TABLE_BITS) - 1)] = (((scrambled >> TABLE_BITS) + 1) << 17)
+        | (static_cast<u64>(move) << 14)
+        | (static_cast<u64>(upper + VALUE_OFFSET) << 7)
+        | static_cast<u64>(lower + VALUE_OFFSET);
+}
+
+void Solver::check_limits() {
+    const auto elapsed = std::chrono::duration<f64, std::milli>(Search::Clock::now() - startTime).count();
+    if (limits.nodes > 0 && nodes >= limits.nodes)
+        stopped = true;
+    if (limits.movetime > 0 && elapsed >= static_cast<f64>(limits.movetime))
+        stopped = true;
+    if (halt != nullptr && halt->load(std::memory_order_relaxed))
+        stopped = true;
+}
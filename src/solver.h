@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "config.h"
+#include "def.h"
+#include "game.h"
+#include "search.h"
+#include "side.h"
+#include "tablebase.h"
+
+class Solver {
+public:
+    /**
+     * @brief The most stones in the pits a position can have to be solved,
+     * each pit fitting in the 5 bits `key` gives it.
+     */
+    static constexpr inline u32 MAX_STONES = 31;
+
+    /**
+     * @brief The default number of stones in the pits at or below which
+     * `AI::find_move` solves instead of searching.
+     */
+    static constexpr inline u32 DEFAULT_STONES = 20;
+
+    /**
+     * @brief The node budget `AI::find_move` gives the solver when only the
+     * depth is limited.
+     */
+    static constexpr inline u64 DEFAULT_NODES = 1 << 20;
+
+    /**
+     * @brief The base-2 logarithm of the number of table slots.
+     */
+    static constexpr inline size TABLE_BITS = 20;
+
+    /**
+     * @brief A solved position.
+     */
+    struct Solution {
+        /**
+         * @brief The best move.
+         */
+        u8 move;
+
+        /**
+         * @brief The final stone difference (PoV minus upper) under perfect play.
+         */
+        i32 diff;
+
+        /**
+         * @brief The principal variation to the end of the game, cut short at
+         * `Search::MAX_DEPTH` moves or where a limit was reached completing it.
+         */
+        Search::Line pv;
+
+        /**
+         * @brief The number of nodes searched.
+         */
+        u64 nodes;
+    };
+
+private:
+    /**
+     * @brief The number of nodes between checks of the limits.
+     */
+    static constexpr inline u64 CHECK_INTERVAL = 1024;
+
+    /**
+     * @brief Offsets a value into the 7 bits a bound is stored in.
+     */
+    static constexpr inline i32 VALUE_OFFSET = 64;
+
+    /**
+     * @brief The bits of a packed key: 5 for each of the 12 pits.
+     */
+    static constexpr inline u64 KEY_MASK = (1ULL << 60) - 1;
+
+    /**
+     * @brief The order given to the table's best move, above any other.
+     */
+    static constexpr inline i32 ORDER_TABLE_MOVE = 1 << 16;
+
+    /**
+     * @brief A position reached by a move, with what the move gained.
+     */
+    struct Child {
+        /**
+         * @brief The position after the move.
+         */
+        Game game;
+
+        /**
+         * @brief The stones the move put in the mover's mancala less those in
+         * the opponent's.
+         */
+        i32 gain;
+
+        /**
+         * @brief The move.
+         */
+        u8 move;
+
+        /**
+         * @brief The order to try the move in, highest first.
+         */
+        i32 order;
+    };
+
+    /**
+     * @brief The bounds and best move stored for a position.
+     */
+    struct Entry {
+        /**
+         * @brief The least the side to move can still capture over its opponent.
+         */
+        i32 lower;
+
+        /**
+         * @brief The most the side to move can still capture over its opponent.
+         */
+        i32 upper;
+
+        /**
+         * @brief The best move found, or 0 if there is none.
+         */
+        u8 move;
+    };
+
+    /**
+     * @brief The table of solved bounds, one packed entry per slot.
+     *
+     * @details A slot holds the part of the scrambled key its index doesn't
+     * give, so a hit is always the same position. Allocated by the first
+     * solve.
+     */
+    std::unique_ptr<u64[]> table;
+
+    /**
+     * @brief The limits of the current solve.
+     */
+    Search::Limits limits;
+
+    /**
+     * @brief When the current solve started.
+     */
+    Search::Clock::time_point startTime;
+
+    /**
+     * @brief The tablebase to look up positions in, if one is loaded.
+     */
+    const Tablebase* tablebase;
+
+    /**
+     * @brief The number of nodes searched in the current solve.
+     */
+    u64 nodes;
+
+    /**
+     * @brief Set from outside the current solve to stop it, or `nullptr`.
+     */
+    const std::atomic<bool>* halt;
+
+    /**
+     * @brief Is `true` once the current solve ran out of time or nodes, or was
+     * halted.
+     */
+    bool stopped;
+
+    /**
+     * @brief The best move at the root of the current solve.
+     */
+    u8 rootMove;
+
+public:
+    Solver();
+
+    /**
+     * @brief Empties the table.
+     */
+    void clear();
+
+    /**
+     * @brief Solves the position by searching to the end of the game, within
+     * the time and node limits (the depth is ignored).
+     *
+     * @details Positions are scored by the stones each side will still capture
+     * from the pits, so the window can only be as wide as the stones left
+     * there. Bounds found are kept between solves, since they don't depend on
+     * how the position was reached.
+     *
+     * @return The solution, or nothing if the position is over, has more than
+     * `MAX_STONES` stones in the pits, or a limit was reached or `halt` set
+     * first.
+     */
+    std::optional<Solution> solve(const Game& game, const Search::Limits& limits, const Tablebase* tablebase, const std::atomic<bool>* halt = nullptr);
+
+    /**
+     * @brief Returns the number of nodes the last solve searched, whether it
+     * finished or not.
+     */
+    u64 n_nodes() const;
+
+private:
+    /**
+     * @brief Returns the stones the side to move will still capture over its
+     * opponent under perfect play, within the window [a, b].
+     */
+    i32 search(const Game& game, i32 a, i32 b, bool isRoot);
+
+    /**
+     * @brief Returns the position's pits, from the side to move's, packed in
+     * 5 bits each.
+     */
+    static u64 key(const Game& game);
+
+    /**
+     * @brief Scrambles a key's bits, one to one, so similar positions spread
+     * across the table.
+     */
+    static u64 scramble(u64 key);
+
+    /**
+     * @brief Returns the entry for the given key, if there is one.
+     */
+    std::optional<Entry> probe(u64 key) const;
+
+    /**
+     * @brief Stores the bounds and best move for the given key.
+     */
+    void store(u64 key, i32 lower, i32 upper, u8 move);
+
+    /**
+     * @brief Sets `stopped` if the time or node limit was reached or `halt` is
+     * set.
+     */
+    void check_limits();
+};
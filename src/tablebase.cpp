@@ -0,0 +1,203 @@
+#include "tablebase.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "movelist.h"
+
+/**
+ * @brief Binomial coefficients, `BINOMIALS[n][k]` being "n choose k".
+ */
+static constexpr auto BINOMIALS = [](){
+    std::array<std::array<u64, 13>, 64> c = {};
+    for (size n = 0; n < c.size(); n++) {
+        c[n][0] = 1;
+        for (size k = 1; k < c[n].size() && k <= n; k++)
+            c[n][k] = c[n - 1][k - 1] + (k < n ? c[n - 1][k] : 0);
+    }
+    return c;
+}();
+
+Tablebase::Tablebase() : file(), values(nullptr), maxStones(0) {
+
+}
+
+Tablebase::~Tablebase() {
+    unload();
+}
+
+bool Tablebase::generate(const std::string& path, const u32 maxStones, const size nThreads) {
+    using Pits = std::array<u8, N_BOARD_PITS>;
+
+    std::vector<i8> values(n_positions(maxStones), 0);
+
+    // Returns the value of the position with `u` to move.
+    const auto value_of = [&values](const Side u, const Side o){
+        return static_cast<i32>(values[index(u, o)]);
+    };
+
+    // Returns the sides of the given pits, the first six being the side to move's.
+    const auto to_sides = [](const Pits& pits){
+        std::array<u8, N_PITS> uPits;
+        std::array<u8, N_PITS> oPits;
+        std::copy(pits.begin(), pits.begin() + N_PITS, uPits.begin());
+        std::copy(pits.begin() + N_PITS, pits.end(), oPits.begin());
+
+        return std::tuple(Side::from_pits(uPits, 0, true), Side::from_pits(oPits, 0, false));
+    };
+
+    // Solves a position from its already solved successors.
+    const auto solve = [&value_of](const Side u, const Side o){
+        const Game game(u, o);
+
+        // The game is over; each side keeps its own stones.
+        if (game.is_over())
+            return u.n_pit_stones() - o.n_pit_stones();
+
+        i32 best = -static_cast<i32>(N_STONES);
+        for (const auto move: game.legal_moves()) {
+            Game child = game;
+            child.make_move_unchecked(move);
+
+            const auto  [a, b]  = child.get_sides();
+            i32         value   = a.mancala() - b.mancala();
+            if (!child.is_over())
+                value += child.is_pov_turn()
+                    ? value_of(a, b)
+                    : -value_of(b, a);
+
+            best = std::max(best, value);
+        }
+
+        return best;
+    };
+
+    for (u32 nStones = 0; nStones <= maxStones; nStones++) {
+        // Group the positions by the sum of their stones' pit numbers.
+        std::vector<std::vector<Pits>>  groups(N_PITS * nStones + 1);
+        Pits                            pits    = {};
+        const auto enumerate = [&](auto& self, const size pit, const u32 left) -> void {
+            if (pit == N_BOARD_PITS - 1) {
+                pits[pit] = static_cast<u8>(left);
+
+                size potential = 0;
+                for (size i = 0; i < N_BOARD_PITS; i++)
+                    potential += (i % N_PITS + 1) * pits[i];
+                groups[potential].push_back(pits);
+                return;
+            }
+
+            for (u32 n = 0; n <= left; n++) {
+                pits[pit] = static_cast<u8>(n);
+                self(self, pit + 1, left - n);
+            }
+        };
+        enumerate(enumerate, 0, nStones);
+
+        // Solve each group in parallel, lowest sum first.
+        for (const auto& group: groups) {
+            std::atomic<size>           next    = 0;
+            std::vector<std::thread>    threads;
+            const auto work = [&](){
+                for (size i = next++; i < group.size(); i = next++) {
+                    const auto [u, o] = to_sides(group[i]);
+                    values[index(u, o)] = static_cast<i8>(solve(u, o));
+                }
+            };
+
+            const size nWorkers = std::clamp<size>(group.size() / 1024, 1, std::max<size>(nThreads, 1));
+            for (size i = 1; i < nWorkers; i++)
+                threads.emplace_back(work);
+            work();
+            for (auto& thread: threads)
+                thread.join();
+        }
+    }
+
+    // Write the header and the values.
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    const Header header = { MAGIC, VERSION, maxStones, 0, values.size() };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size()));
+
+    return static_cast<bool>(out);
+}
+
+bool Tablebase::load(const std::string& path) {
+    unload();
+    if (!file.open(path))
+        return false;
+
+    // Check that the file is a complete tablebase.
+    const size      fileSize    = file.size_bytes();
+    const Header&   header      = *reinterpret_cast<const Header*>(file.data());
+    if (fileSize < sizeof(Header)
+        || header.magic != MAGIC
+        || header.version != VERSION
+        || header.maxStones > MAX_STONES
+        || header.nPositions != n_positions(header.maxStones)
+        || fileSize != sizeof(Header) + header.nPositions
+    ) {
+        file.close();
+        return false;
+    }
+
+    values      = reinterpret_cast<const i8*>(file.data() + sizeof(Header));
+    maxStones   = header.maxStones;
+
+    return true;
+}
+
+void Tablebase::unload() {
+    file.close();
+    values      = nullptr;
+    maxStones   = 0;
+}
+
+bool Tablebase::is_loaded() const {
+    return values != nullptr;
+}
+
+u32 Tablebase::max_stones() const {
+    return maxStones;
+}
+
+__attribute__((hot))
+std::optional<i32> Tablebase::probe(const Game& game) const {
+    if (!covers(game))
+        return std::nullopt;
+
+    // Add what's left to win to what's already in the mancalas.
+    const auto  [a, b]  = game.get_sides();
+    const auto  [u, o]  = game.get_turn_user_opp();
+    const i32   value   = values[index(u, o)];
+
+    return a.mancala() - b.mancala() + (game.is_pov_turn() ? value : -value);
+}
+
+u64 Tablebase::n_positions(const u32 nStones) {
+    return BINOMIALS[nStones + N_BOARD_PITS][N_BOARD_PITS];
+}
+
+__attribute__((hot))
+u64 Tablebase::index(const Side u, const Side o) {
+    // Place a bar after each pit but the last; the bars' positions are a
+    // combination whose rank identifies the pits among those with as many stones.
+    u64 rank    = 0;
+    u64 bar     = 0;
+    for (size i = 1; i < N_BOARD_PITS; i++) {
+        bar  += static_cast<u64>(i <= N_PITS ? u.pit(static_cast<u8>(i)) : o.pit(static_cast<u8>(i - N_PITS)));
+        rank += BINOMIALS[bar + i - 1][i];
+    }
+
+    const u32 nStones = static_cast<u32>(u.n_pit_stones() + o.n_pit_stones());
+    return (nStones > 0 ? n_positions(nStones - 1) : 0) + rank;
+}
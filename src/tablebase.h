@@ -0,0 +1,153 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "config.h"
+#include "def.h"
+#include "game.h"
+#include "mappedfile.h"
+#include "side.h"
+
+class Tablebase {
+public:
+    /**
+     * @brief The most stones in play a tablebase can be generated for.
+     */
+    static constexpr inline u32 MAX_STONES = 24;
+
+private:
+    /**
+     * @brief The number of pits on the board.
+     */
+    static constexpr inline size N_BOARD_PITS = N_PITS * 2;
+
+    /**
+     * @brief The file's header.
+     */
+    struct Header {
+        /**
+         * @brief Always `MAGIC`.
+         */
+        u32 magic;
+
+        /**
+         * @brief Always `VERSION`.
+         */
+        u32 version;
+
+        /**
+         * @brief The most stones in play covered.
+         */
+        u32 maxStones;
+
+        /**
+         * @brief Unused.
+         */
+        u32 reserved;
+
+        /**
+         * @brief The number of positions stored after the header.
+         */
+        u64 nPositions;
+    };
+
+    /**
+     * @brief Identifies a tablebase file ("RHTB").
+     */
+    static constexpr inline u32 MAGIC = 0x42544852;
+
+    /**
+     * @brief The file format version.
+     */
+    static constexpr inline u32 VERSION = 1;
+
+    /**
+     * @brief The loaded file.
+     */
+    MappedFile file;
+
+    /**
+     * @brief The stored values, indexed by `index`.
+     *
+     * @details Each value is the difference between the stones the side to move
+     * and its opponent will still capture from the pits under perfect play.
+     */
+    const i8* values;
+
+    /**
+     * @brief The most stones in play covered.
+     */
+    u32 maxStones;
+
+public:
+    Tablebase();
+
+    ~Tablebase();
+
+    Tablebase(const Tablebase&) = delete;
+
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    /**
+     * @brief Solves every position with up to the given number of stones in the
+     * pits and writes the results to the given file.
+     *
+     * @details Positions are solved by retrograde analysis from the empty board
+     * up, one stone count at a time. Within a stone count, moves that keep every
+     * stone in play always lower the sum of the stones' pit numbers, so positions
+     * are solved in order of that sum, each group in parallel.
+     *
+     * @return `true` on success, `false` if the file could not be written.
+     */
+    static bool generate(const std::string& path, u32 maxStones, size nThreads);
+
+    /**
+     * @brief Memory-maps the given tablebase file, replacing any loaded one.
+     *
+     * @return `true` on success, `false` if the file is missing or invalid.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Unmaps the loaded file, if any.
+     */
+    void unload();
+
+    /**
+     * @brief Returns `true` if a tablebase is loaded.
+     */
+    bool is_loaded() const;
+
+    /**
+     * @brief Returns the most stones in play covered, or 0 if none is loaded.
+     */
+    u32 max_stones() const;
+
+    /**
+     * @brief Returns `true` if the position is in the loaded tablebase.
+     */
+    inline bool covers(const Game& game) const {
+        return values != nullptr && game.n_pit_stones() <= static_cast<i32>(maxStones);
+    }
+
+    /**
+     * @brief Returns the final stone difference (PoV minus upper) under perfect
+     * play, if the position is covered.
+     */
+    std::optional<i32> probe(const Game& game) const;
+
+private:
+    /**
+     * @brief Returns the number of positions with up to the given number of stones in play.
+     */
+    static u64 n_positions(u32 nStones);
+
+    /**
+     * @brief Returns the index of the position with the given pits, with `u` to move.
+     *
+     * @details Positions are ordered by stones in play, then by the rank of the
+     * pits' composition in the combinatorial number system.
+     */
+    static u64 index(Side u, Side o);
+};
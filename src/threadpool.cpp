@@ -0,0 +1,61 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(const size nWorkers) : workers(), threads(), quit(false) {
+    for (size i = 0; i < nWorkers; i++)
+        workers.push_back(std::make_unique<Worker>());
+
+    for (size i = 1; i < nWorkers; i++)
+        threads.emplace_back([this, i](){ work(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    quit.store(true, std::memory_order_relaxed);
+    for (auto& thread: threads)
+        thread.join();
+}
+
+size ThreadPool::n_workers() const {
+    return workers.size();
+}
+
+void ThreadPool::push(const size worker, Task task) {
+    std::lock_guard lock(workers[worker]->mutex);
+    workers[worker]->tasks.push_back(std::move(task));
+}
+
+bool ThreadPool::run_one(const size worker) {
+    const size  nWorkers    = workers.size();
+    Task        task;
+
+    // Take the newest task of our own, whose subtree is smallest and hottest in cache.
+    {
+        Worker& own = *workers[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    // Otherwise steal the oldest task of another worker, whose subtree is largest.
+    for (size i = 1; !task && i < nWorkers; i++) {
+        Worker& victim = *workers[(worker + i) % nWorkers];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+        return false;
+
+    task(worker);
+    return true;
+}
+
+void ThreadPool::work(const size worker) {
+    while (!quit.load(std::memory_order_relaxed))
+        if (!run_one(worker))
+            std::this_thread::yield();
+}
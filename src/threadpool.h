@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "def.h"
+
+class ThreadPool {
+public:
+    /**
+     * @brief A unit of work, given the index of the worker running it.
+     */
+    using Task = std::function<void(size worker)>;
+
+private:
+    struct Worker {
+        /**
+         * @brief Guards `tasks`.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief The worker's tasks; the owner takes from the back, thieves from the front.
+         */
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * @brief Each worker's deque.
+     */
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /**
+     * @brief The pool's threads, one per worker except worker 0.
+     */
+    std::vector<std::thread> threads;
+
+    /**
+     * @brief Set to make the threads exit.
+     */
+    std::atomic<bool> quit;
+
+public:
+    /**
+     * @brief A pool with the given number of workers.
+     *
+     * @details Worker 0 is the thread that owns the pool; it only runs tasks
+     * while it calls `run_one`.
+     */
+    explicit ThreadPool(size nWorkers);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the number of workers.
+     */
+    size n_workers() const;
+
+    /**
+     * @brief Adds a task to the given worker's deque.
+     */
+    void push(size worker, Task task);
+
+    /**
+     * @brief Runs one task as the given worker, taking the newest of its own or
+     * else stealing the oldest of another worker's.
+     *
+     * @return `true` if a task was run, `false` if there was none.
+     */
+    bool run_one(size worker);
+
+private:
+    /**
+     * @brief The loop of a pool thread.
+     */
+    void work(size worker);
+};
@@ -0,0 +1,87 @@
+#include "ttable.h"
+
+#include <algorithm>
+#include <bit>
+
+TTable::TTable(const size mb) : slots(), nSlots(0), mask(0), age(0) {
+    resize(mb);
+}
+
+size TTable::size_mb() const {
+    return (nSlots * sizeof(Slot)) >> 20;
+}
+
+void TTable::resize(const size mb) {
+    // Fit as many slots as possible (at least one) within the given size,
+    // allocating before anything changes so a failure keeps the old table.
+    const size n = std::bit_floor(std::max<size>((mb << 20) / sizeof(Slot), 1));
+    slots   = std::make_unique<Slot[]>(n);
+    nSlots  = n;
+    mask    = nSlots - 1;
+}
+
+void TTable::clear() {
+    for (size i = 0; i < nSlots; i++) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+    age.store(0, std::memory_order_relaxed);
+}
+
+void TTable::new_search() {
+    age.fetch_add(1, std::memory_order_relaxed);
+}
+
+__attribute__((hot))
+std::optional<TTable::Entry> TTable::probe(const u64 key) const {
+    const Slot& slot    = slots[key & mask];
+    const u64   data    = slot.data.load(std::memory_order_relaxed);
+    const u64   check   = slot.check.load(std::memory_order_relaxed);
+    const Entry entry   = unpack(data);
+
+    if (entry.bound != Bound::NONE && (check ^ data) == key)
+        return entry;
+    else
+        return std::nullopt;
+}
+
+__attribute__((hot))
+void TTable::store(const u64 key, const i32 depth, const i32 score, const Bound bound, const u8 move) {
+    Slot&       slot        = slots[key & mask];
+    const u64   oldData     = slot.data.load(std::memory_order_relaxed);
+    const bool  isSameKey   = (slot.check.load(std::memory_order_relaxed) ^ oldData) == key;
+    const Entry old         = unpack(oldData);
+    const u8    newDepth    = static_cast<u8>(std::clamp(depth, 0, 255));
+    const u8    curAge      = age.load(std::memory_order_relaxed);
+
+    // Keep deeper results from this search.
+    if (old.age == curAge && old.depth > newDepth)
+        return;
+
+    // Keep the old best move if the new result has none.
+    const u8 newMove = (move == 0 && isSameKey)
+        ? old.move
+        : move;
+
+    const u64 data = pack(Entry{ score, newDepth, bound, newMove, curAge });
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+u64 TTable::pack(const Entry entry) {
+    return static_cast<u64>(static_cast<u32>(entry.score))
+        | (static_cast<u64>(entry.depth) << 32)
+        | (static_cast<u64>(entry.bound) << 40)
+        | (static_cast<u64>(entry.move) << 48)
+        | (static_cast<u64>(entry.age) << 56);
+}
+
+TTable::Entry TTable::unpack(const u64 data) {
+    return Entry{
+        static_cast<i32>(static_cast<u32>(data)),
+        static_cast<u8>(data >> 32),
+        static_cast<Bound>(static_cast<u8>(data >> 40)),
+        static_cast<u8>(data >> 48),
+        static_cast<u8>(data >> 56),
+    };
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "def.h"
+
+class TTable {
+public:
+    /**
+     * @brief How a stored score relates to the position's true score.
+     */
+    enum class Bound : u8 {
+        NONE,
+        EXACT,
+        LOWER,
+        UPPER,
+    };
+
+    struct Entry {
+        /**
+         * @brief The score found for the game.
+         */
+        i32 score;
+
+        /**
+         * @brief The depth the game was searched to.
+         */
+        u8 depth;
+
+        /**
+         * @brief The type of score stored.
+         */
+        Bound bound;
+
+        /**
+         * @brief The best move found, or 0 if there is none.
+         */
+        u8 move;
+
+        /**
+         * @brief The search the entry was written in.
+         */
+        u8 age;
+    };
+
+    /**
+     * @brief The default size of the table in megabytes.
+     */
+    static constexpr inline size DEFAULT_MB = 16;
+
+private:
+    /**
+     * @brief A lock-free slot holding one entry.
+     *
+     * @details The key is stored XOR-ed with the packed entry, so a slot torn by
+     * two threads writing at once fails the key check instead of giving a wrong
+     * entry.
+     */
+    struct Slot {
+        /**
+         * @brief The key XOR-ed with `data`.
+         */
+        std::atomic<u64> check;
+
+        /**
+         * @brief The packed entry.
+         */
+        std::atomic<u64> data;
+    };
+
+    /**
+     * @brief The table's slots.
+     */
+    std::unique_ptr<Slot[]> slots;
+
+    /**
+     * @brief The number of slots, always a power of two.
+     */
+    size nSlots;
+
+    /**
+     * @brief A bitmask to turn a key into an entry index.
+     */
+    u64 mask;
+
+    /**
+     * @brief The current search's age.
+     *
+     * @note Atomic since searches of different games may share the table and
+     * run while its owner ages it.
+     */
+    std::atomic<u8> age;
+
+public:
+    explicit TTable(size mb = DEFAULT_MB);
+
+    /**
+     * @brief Returns the size of the table in megabytes.
+     */
+    size size_mb() const;
+
+    /**
+     * @brief Resizes the table to the given number of megabytes, clearing it.
+     *
+     * @details The number of entries is rounded down to a power of two.
+     *
+     * @throws std::bad_alloc if the memory can't be allocated, leaving the
+     * table as it was.
+     */
+    void resize(size mb);
+
+    /**
+     * @brief Empties the table.
+     */
+    void clear();
+
+    /**
+     * @brief Marks the start of a new search so old entries can be replaced.
+     */
+    void new_search();
+
+    /**
+     * @brief Returns the entry for the given key, if there is one.
+     *
+     * @note Safe to call while other threads probe and store.
+     */
+    std::optional<Entry> probe(u64 key) const;
+
+    /**
+     * @brief Stores a search result.
+     *
+     * @details Entries are only replaced by searches of equal or greater depth,
+     * unless they are left over from a previous search.
+     *
+     * @note Safe to call while other threads probe and store.
+     */
+    void store(u64 key, i32 depth, i32 score, Bound bound, u8 move);
+
+private:
+    /**
+     * @brief Packs an entry into a single word.
+     */
+    static u64 pack(Entry entry);
+
+    /**
+     * @brief Unpacks an entry from a single word.
+     */
+    static Entry unpack(u64 data);
+};